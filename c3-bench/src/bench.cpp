@@ -0,0 +1,787 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#include "../../c3-network-copilot/include/chess-batch.h"
+#include "../../c3-network-copilot/include/chess-game.h"
+#include "../../c3-network-copilot/include/chess-record.h"
+#include "../../c3-network-copilot/include/chess-rules.h"
+#include "../../c3-network-copilot/include/chess-sparse.h"
+#include "../../c3-network-copilot/include/LanP2PNode.h"
+using namespace std;
+
+//Ϸĵ΢׼place / UpdateBoardState / CheckWin / OnlineInitChessBoardԾֻطţCheckWinCheckMovesBatch
+//򼯣GetChessRuleSet8^3壩ļ⣬ϡ̵ĶԱȣڴ棩ԼLanP2PNodeϢķַ
+//÷c3-bench [json·] [--quick] [--records Ծּ¼ļ]
+//--recordsطż¼ļchess-record.hеĶԾ֣ʱطŹ̶ɵԾ
+//⺯첽־chess-log.hReleaseMOVE_ACCEPTEDDebug𱻱ȥڼstdoutض򵽿豸дstderr
+
+//ͳoperator newֽcallocOnlineInitChessBoardcalloc
+static atomic<uint64_t> g_allocs{ 0 };
+static atomic<uint64_t> g_allocBytes{ 0 };
+
+void *operator new(size_t size)
+{
+	g_allocs.fetch_add(1, memory_order_relaxed);
+	g_allocBytes.fetch_add(size, memory_order_relaxed);
+	void *p = malloc(size ? size : 1);
+	if (!p)
+		throw bad_alloc();
+	return p;
+}
+
+void operator delete(void *p) noexcept
+{
+	free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+	free(p);
+}
+
+struct BenchResult
+{
+	string name;
+	int boardSize;
+	double density;          //<0ʾܶ޹
+	uint64_t ops;
+	double nsPerOp;
+	double allocsPerOp;
+	double bytesPerOp;
+	double mallocsPerOp;     //C䣨calloc
+	double boardBytes;       //ռõڴ棬0ʾ
+};
+
+struct BenchConfig
+{
+	double minMs{ 200.0 };   //ÿٲô
+};
+
+//ظbody(batch)ֱۼʱ䳬minMsbodyرɵĲ
+template <class Body>
+static BenchResult RunBench(const BenchConfig &cfg, const char *name, int boardSize, double density, Body body)
+{
+	BenchResult r = { name, boardSize, density, 0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+	body(16);//Ԥ
+	uint64_t allocs0 = g_allocs.load(), bytes0 = g_allocBytes.load();
+	double elapsedNs = 0.0;
+	uint64_t batch = 64;
+	while (elapsedNs < cfg.minMs * 1e6)
+	{
+		chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+		r.ops += body(batch);
+		elapsedNs += chrono::duration<double, nano>(chrono::steady_clock::now() - t0).count();
+		if (batch < (1u << 20))
+			batch *= 2;
+	}
+	r.nsPerOp = elapsedNs / (double)r.ops;
+	r.allocsPerOp = (double)(g_allocs.load() - allocs0) / (double)r.ops;
+	r.bytesPerOp = (double)(g_allocBytes.load() - bytes0) / (double)r.ops;
+	fprintf(stderr, "%-20s N=%-4d density=%-5.2f %12.1f ns/op  allocs/op=%.3f\n", name, boardSize, density < 0 ? 0.0 : density,
+	        r.nsPerOp, r.allocsPerOp);
+	return r;
+}
+
+//ܶӣ˫棩ؿλλб
+static void FillBoard(char *board, int N, double density, mt19937_64 &rng, vector<int> &empties, vector<int> &stones)
+{
+	const int cells = N * N * N;
+	empties.clear();
+	stones.clear();
+	uniform_real_distribution<double> u(0.0, 1.0);
+	for (int c = 0; c < cells; c++)
+	{
+		if (u(rng) < density)
+		{
+			board[c] = (stones.size() % 2) ? '2' : '1';
+			stones.push_back(c);
+		}
+		else
+		{
+			board[c] = 0;
+			empties.push_back(c);
+		}
+	}
+	shuffle(empties.begin(), empties.end(), rng);
+	shuffle(stones.begin(), stones.end(), rng);
+}
+
+static void ToInput(int cell, int N, int input[3])
+{
+	input[0] = cell % N + 1;
+	input[1] = cell / N % N + 1;
+	input[2] = cell / (N * N) + 1;
+}
+
+static void WriteJson(const char *path, const vector<BenchResult> &results)
+{
+	FILE *f = fopen(path, "w");
+	if (!f)
+	{
+		fprintf(stderr, "cannot write %s\n", path);
+		return;
+	}
+	fprintf(f, "{\n  \"schema\": 1,\n  \"results\": [\n");
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const BenchResult &r = results[i];
+		fprintf(f, "    {\"name\": \"%s\", \"boardSize\": %d, ", r.name.c_str(), r.boardSize);
+		if (r.density < 0)
+			fprintf(f, "\"density\": null, ");
+		else
+			fprintf(f, "\"density\": %.2f, ", r.density);
+		fprintf(f, "\"ops\": %llu, \"nsPerOp\": %.2f, \"allocsPerOp\": %.4f, \"bytesPerOp\": %.2f, \"mallocsPerOp\": %.4f, ",
+		        (unsigned long long)r.ops, r.nsPerOp, r.allocsPerOp, r.bytesPerOp, r.mallocsPerOp);
+		fprintf(f, "\"boardBytes\": %.0f}%s\n", r.boardBytes, i + 1 < results.size() ? "," : "");
+	}
+	fprintf(f, "  ]\n}\n");
+	fclose(f);
+	fprintf(stderr, "results written to %s\n", path);
+}
+
+//ЭϢͷmagic version type + ģּLanP2PNode.cpp
+static string WireMessage(uint8_t type, const string &body)
+{
+	string m;
+	m.push_back((char)0xC3);
+	m.push_back(1);
+	m.push_back((char)type);
+	m.push_back(0);
+	return m + body;
+}
+
+static void PutLE(string &out, uint64_t v, int bytes)
+{
+	for (int i = 0; i < bytes; i++)
+		out.push_back((char)((v >> (8 * i)) & 0xFF));
+}
+
+//LanP2PNodeϢַ磬injectFrameַ֡ıЭֱ⣻صֻ
+//Զ˱16ԶˣϢһƥ䴦ڻԾ״̬INTƥԶˣ
+static void BenchDispatch(const BenchConfig &cfg, vector<BenchResult> &results)
+{
+	lanp2p::LanP2PNode node(0, 0);
+	uint64_t calls = 0;
+	node.setOnMatchRequest([&](const lanp2p::PeerInfo &, const string &)
+	{
+		calls++;
+	});
+	node.setOnMatchResponse([&](const lanp2p::PeerInfo &, bool, const string &)
+	{
+		calls++;
+	});
+	node.setOnMatchInterrupted([&](const lanp2p::PeerInfo &, const string &)
+	{
+		calls++;
+	});
+	node.setOnGameMove([&](const lanp2p::PeerInfo &, int, int, int)
+	{
+		calls++;
+	});
+
+	const string ip = "192.168.1.20";
+	const string peerId = "0123456789abcdef", matchId = "00000000000000ff";
+	const uint64_t peerNum = 0x0123456789abcdefull, matchNum = 0xff, nodeNum = strtoull(node.getNodeId().c_str(), nullptr, 16);
+	char other[64];
+	for (int i = 0; i < 15; i++)
+	{
+		snprintf(other, sizeof(other), "REQ|%016x|5000|%016x|", i + 1, i + 1);
+		node.injectFrame("192.168.1." + to_string(100 + i), other, strlen(other));
+	}
+	string req = "REQ|" + peerId + "|5000|" + matchId + "|" + node.getNodeId() + "|";
+	node.injectFrame(ip, req.data(), req.size());
+
+	string body;
+	PutLE(body, peerNum, 8);
+	PutLE(body, matchNum, 8);
+	const string idsBody = body;
+	PutLE(body, nodeNum, 8);
+	PutLE(body, 5000, 2);
+	const string reqBin = WireMessage(1, body);
+	const string respBin = WireMessage(2, idsBody + string(1, '\1'));
+	const string intBin = WireMessage(3, idsBody);
+	const string hbBin = WireMessage(4, idsBody);
+	body.clear();
+	PutLE(body, 3, 2);
+	PutLE(body, 4, 2);
+	PutLE(body, 5, 2);
+	PutLE(body, 0, 2);
+	const string moveBin = WireMessage(5, body);
+
+	// INTɾԶƥ䣬֮INTֻߡδҵĽݾINTÿǰעһREQREQ+INTһ
+	const struct
+	{
+		const char *name;
+		string frame;
+		string setup;          // ǿʱÿϢǰע룬
+	} cases[] =
+	{
+		{ "dispatch MOVE", "MOVE|3|4|5|", string() },
+		{ "dispatch MOVE/bin", moveBin, string() },
+		{ "dispatch HB", "HB|" + peerId + "|" + matchId + "|", string() },
+		{ "dispatch HB/bin", hbBin, string() },
+		{ "dispatch REQ", req, string() },
+		{ "dispatch REQ/bin", reqBin, string() },
+		{ "dispatch RESP", "RESP|" + peerId + "|" + matchId + "|1|", string() },
+		{ "dispatch RESP/bin", respBin, string() },
+		{ "dispatch REQ+INT", "INT|" + peerId + "|" + matchId + "|", req },
+		{ "dispatch REQ+INT/bin", intBin, reqBin },
+	};
+	for (const auto &c : cases)
+	{
+		const string &frame = c.frame;
+		const string &setup = c.setup;
+		results.push_back(RunBench(cfg, c.name, 0, -1.0, [&](uint64_t batch)
+		{
+			for (uint64_t i = 0; i < batch; i++)
+			{
+				if (!setup.empty())
+					node.injectFrame(ip, setup.data(), setup.size());
+				node.injectFrame(ip, frame.data(), frame.size());
+			}
+			return batch;
+		}));
+		fprintf(stderr, "%-20s %12.0f msgs/s\n", c.name, 1e9 / results.back().nsPerOp);
+	}
+	if (calls == 0)
+		fprintf(stderr, "warning: dispatch callbacks were not invoked\n");
+}
+
+//ϡ̶Աỵ̄ӿK̡ÿCheckWinͷţԼӴCheckWin
+//boardBytes¼Kʱ̸ռõڴ
+static void BenchSparse(const BenchConfig &cfg, mt19937_64 &rng, vector<BenchResult> &results)
+{
+	const int sizes[] = { 100, 200 };
+	const int stoneCounts[] = { 1000, 100000 };
+	for (int N : sizes)
+	{
+		const int cells = N * N * N;
+		for (int K : stoneCounts)
+		{
+			const double density = (double)K / cells;
+			// Kظӣ˫
+			vector<int> moves;
+			{
+				vector<char> taken((size_t)cells, 0);
+				moves.reserve(K);
+				while ((int)moves.size() < K)
+				{
+					int c = (int)(rng() % cells);
+					if (!taken[c])
+					{
+						taken[c] = 1;
+						moves.push_back(c);
+					}
+				}
+			}
+			volatile int sink = 0;
+
+			results.push_back(RunBench(cfg, "dense game", N, density, [&](uint64_t ops)
+			{
+				const uint64_t games = max<uint64_t>(1, ops / K);
+				int wins = 0, input[3];
+				for (uint64_t g = 0; g < games; g++)
+				{
+					char *board = nullptr;
+					if (!OnlineInitChessBoard(&board, N))
+						return (uint64_t)0;
+					for (int i = 0; i < K; i++)
+					{
+						const char player = (i & 1) ? '2' : '1';
+						ToInput(moves[i], N, input);
+						UpdateBoardState(N, board, input, player);
+						wins += CheckWin(N, board, input, player);
+					}
+					free(board);
+				}
+				sink = sink + wins;
+				return games * K;
+			}));
+			results.back().mallocsPerOp = 1.0 / K;
+			results.back().boardBytes = (double)cells;
+
+			results.push_back(RunBench(cfg, "sparse game", N, density, [&](uint64_t ops)
+			{
+				const uint64_t games = max<uint64_t>(1, ops / K);
+				int wins = 0, input[3];
+				for (uint64_t g = 0; g < games; g++)
+				{
+					ChessSparseBoard board;
+					if (!OnlineInitSparseBoard(&board, N))
+						return (uint64_t)0;
+					for (int i = 0; i < K; i++)
+					{
+						const char player = (i & 1) ? '2' : '1';
+						ToInput(moves[i], N, input);
+						UpdateSparseBoardState(board, input, player);
+						wins += CheckWinSparseBoard(board, input, player);
+					}
+					FreeSparseBoard(&board);
+				}
+				sink = sink + wins;
+				return games * K;
+			}));
+
+			// ̶KӴ
+			char *dense = nullptr;
+			ChessSparseBoard sparse;
+			if (!OnlineInitChessBoard(&dense, N) || !OnlineInitSparseBoard(&sparse, N))
+				return;
+			for (int i = 0; i < K; i++)
+			{
+				int input[3];
+				ToInput(moves[i], N, input);
+				UpdateBoardState(N, dense, input, (i & 1) ? '2' : '1');
+				UpdateSparseBoardState(sparse, input, (i & 1) ? '2' : '1');
+			}
+			const double sparseBytes = (double)SparseBoardBytes(sparse);
+			results.back().boardBytes = sparseBytes;
+
+			results.push_back(RunBench(cfg, "dense CheckWin", N, density, [&](uint64_t batch)
+			{
+				int wins = 0, input[3];
+				for (uint64_t i = 0; i < batch; i++)
+				{
+					const int j = (int)(i % K);
+					ToInput(moves[j], N, input);
+					wins += CheckWin(N, dense, input, (j & 1) ? '2' : '1');
+				}
+				sink = sink + wins;
+				return batch;
+			}));
+			results.back().boardBytes = (double)cells;
+			results.push_back(RunBench(cfg, "sparse CheckWin", N, density, [&](uint64_t batch)
+			{
+				int wins = 0, input[3];
+				for (uint64_t i = 0; i < batch; i++)
+				{
+					const int j = (int)(i % K);
+					ToInput(moves[j], N, input);
+					wins += CheckWinSparseBoard(sparse, input, (j & 1) ? '2' : '1');
+				}
+				sink = sink + wins;
+				return batch;
+			}));
+			results.back().boardBytes = sparseBytes;
+			fprintf(stderr, "board memory N=%d stones=%d: dense %d bytes, sparse %.0f bytes\n", N, K, cells, sparseBytes);
+			free(dense);
+			FreeSparseBoard(&sparse);
+		}
+	}
+}
+
+//һֵУִӷü¼ļĸʽ
+struct BenchGame
+{
+	int boardSize;
+	vector<ChessRecordMove> moves;
+};
+
+//ȡ¼ļеȫԾ
+static bool LoadRecordGames(const char *path, vector<BenchGame> &games)
+{
+	ChessRecordArchive archive;
+	if (!archive.open(path))
+	{
+		fprintf(stderr, "cannot open records %s\n", path);
+		return false;
+	}
+	uint64_t offset = 0;
+	const ChessRecordHeader *header;
+	const ChessRecordMove *moves;
+	while (archive.next(offset, header, moves))
+	{
+		if (header->moveCount == 0)
+			continue;
+		games.push_back(BenchGame{ header->boardSize, vector<ChessRecordMove>(moves, moves + header->moveCount) });
+	}
+	return true;
+}
+
+//Ծ֣˫ĸspan^3ӣֱwinLengthӡﵽmaxMoves
+static void RandomGames(int N, int winLength, int count, int maxMoves, mt19937_64 &rng, vector<BenchGame> &games)
+{
+	ChessRuleSet rules;
+	if (!GetChessRuleSet(N, winLength, &rules))
+		return;
+	const int span = min(N, 6), lo = (N - span) / 2;
+	vector<char> board((size_t)N * N * N);
+	for (int g = 0; g < count; g++)
+	{
+		fill(board.begin(), board.end(), 0);
+		BenchGame game{ N, {} };
+		char player = '1';
+		for (int n = 0; n < maxMoves && n < span * span * span; n++)
+		{
+			int input[3], cell;
+			do
+			{
+				for (int a = 0; a < 3; a++)
+					input[a] = lo + (int)(rng() % span) + 1;
+				cell = place(input[0], input[1], input[2], N);
+			}
+			while (board[cell] != 0);
+			board[cell] = player;
+			ChessRecordMove m = { (uint8_t)input[0], (uint8_t)input[1], (uint8_t)input[2], (uint8_t)player, 0 };
+			game.moves.push_back(m);
+			if (CheckWinRules(rules, board.data(), input, player))
+				break;
+			player = player == '1' ? '2' : '1';
+		}
+		games.push_back(game);
+	}
+}
+
+//ԾֻطţӲCheckWinԾѭԱCheckMovesBatchһУȫÿָò֮ǰ̿գ
+//ߵĽ𲽺˶ԣһʱ
+static void BenchReplay(const BenchConfig &cfg, const vector<BenchGame> &games, vector<BenchResult> &results)
+{
+	// ޵ĶԾֲμ
+	static const size_t MaxSnapshotBytes = (size_t)256 << 20;
+	vector<const BenchGame *> used;
+	size_t snapshotBytes = 0, moveCount = 0;
+	for (const BenchGame &g : games)
+	{
+		const size_t bytes = (size_t)g.boardSize * g.boardSize * g.boardSize * g.moves.size();
+		if (g.boardSize <= 0 || snapshotBytes + bytes > MaxSnapshotBytes)
+			continue;
+		used.push_back(&g);
+		snapshotBytes += bytes;
+		moveCount += g.moves.size();
+	}
+	if (moveCount == 0)
+	{
+		fprintf(stderr, "replay: no games\n");
+		return;
+	}
+
+	// 𲽻طŵõͬʱÿ֮ǰ
+	vector<char> snapshots(snapshotBytes);
+	vector<ChessBatchMove> batch;
+	vector<ChessBatchResult> expect;
+	batch.reserve(moveCount);
+	expect.reserve(moveCount);
+	size_t offset = 0;
+	for (const BenchGame *g : used)
+	{
+		const int N = g->boardSize, cells = N * N * N;
+		vector<char> board((size_t)cells);
+		for (const ChessRecordMove &m : g->moves)
+		{
+			memcpy(&snapshots[offset], board.data(), (size_t)cells);
+			ChessBatchMove b = { &snapshots[offset], N, { m.x, m.y, m.z }, (char)m.player };
+			batch.push_back(b);
+			offset += (size_t)cells;
+			ChessBatchResult r = { ChessBatchLegal, -1 };
+			if (b.player != '1' && b.player != '2')
+				r.status = ChessBatchBadPlayer;
+			else if (m.x < 1 || m.x > N || m.y < 1 || m.y > N || m.z < 1 || m.z > N)
+				r.status = ChessBatchOutOfRange;
+			else if (board[place(m.x, m.y, m.z, N)] != 0)
+				r.status = ChessBatchOccupied;
+			else
+			{
+				board[place(m.x, m.y, m.z, N)] = b.player;
+				r.winDirection = CheckWin(N, board.data(), b.input, b.player) ? 0 : -1;
+			}
+			expect.push_back(r);
+		}
+	}
+	vector<ChessBatchResult> got(moveCount);
+	CheckMovesBatch(batch.data(), moveCount, got.data(), 0);
+	size_t mismatches = 0, wins = 0;
+	for (size_t i = 0; i < moveCount; i++)
+	{
+		wins += expect[i].winDirection >= 0;
+		if (got[i].status != expect[i].status || (got[i].winDirection >= 0) != (expect[i].winDirection >= 0))
+			mismatches++;
+	}
+	fprintf(stderr, "replay: %zu games, %zu moves, %zu wins\n", used.size(), moveCount, wins);
+	if (mismatches > 0)
+		fprintf(stderr, "ERROR CheckMovesBatch disagrees with CheckWin on %zu of %zu moves\n", mismatches, moveCount);
+
+	const int boardSize = used[0]->boardSize;
+	volatile size_t sink = 0;
+	// 𲽣ÿִӿ̿ʼӲCheckWinԾѭͬ
+	vector<char> board;
+	results.push_back(RunBench(cfg, "replay CheckWin", boardSize, -1.0, [&](uint64_t ops)
+	{
+		const uint64_t passes = max<uint64_t>(1, ops / moveCount);
+		size_t n = 0;
+		for (uint64_t p = 0; p < passes; p++)
+		{
+			for (const BenchGame *g : used)
+			{
+				const int N = g->boardSize;
+				board.assign((size_t)N * N * N, 0);
+				for (const ChessRecordMove &m : g->moves)
+				{
+					if (m.x < 1 || m.x > N || m.y < 1 || m.y > N || m.z < 1 || m.z > N)
+						continue;
+					int input[3] = { m.x, m.y, m.z };
+					char &c = board[place(m.x, m.y, m.z, N)];
+					if (c != 0)
+						continue;
+					c = (char)m.player;
+					n += CheckWin(N, board.data(), input, (char)m.player);
+				}
+			}
+		}
+		sink = sink + n;
+		return passes * moveCount;
+	}));
+	const struct
+	{
+		const char *name;
+		int threads;
+	} batchCases[] =
+	{
+		{ "replay CheckMovesBatch", 1 },
+		{ "replay CheckMovesBatch/mt", 0 },
+	};
+	for (const auto &c : batchCases)
+	{
+		results.push_back(RunBench(cfg, c.name, boardSize, -1.0, [&](uint64_t ops)
+		{
+			const uint64_t passes = max<uint64_t>(1, ops / moveCount);
+			for (uint64_t p = 0; p < passes; p++)
+				CheckMovesBatch(batch.data(), moveCount, got.data(), c.threads);
+			sink = sink + got[0].status;
+			return passes * moveCount;
+		}));
+	}
+}
+
+//ִӿ̿ʼӣcheck(board, N, input, player)ط0ʾɣɵĲ
+template <class Check>
+static size_t ReplayGames(const vector<BenchGame> &games, vector<char> &board, Check &&check)
+{
+	size_t wins = 0;
+	for (const BenchGame &g : games)
+	{
+		const int N = g.boardSize;
+		board.assign((size_t)N * N * N, 0);
+		for (const ChessRecordMove &m : g.moves)
+		{
+			int input[3] = { m.x, m.y, m.z };
+			board[place(m.x, m.y, m.z, N)] = (char)m.player;
+			wins += check(board.data(), N, input, (char)m.player) != 0;
+		}
+	}
+	return wins;
+}
+
+//򼯣GetChessRuleSetȡļ⺯бػԱChessRulesDynamic߶ӡԱCheckWinʱд첽־
+//ԾְԹɣ8^3ֻйж
+static void BenchRules(const BenchConfig &cfg, mt19937_64 &rng, vector<BenchResult> &results)
+{
+	const struct
+	{
+		int boardSize;
+		int winLength;
+	} variants[] =
+	{
+		{ 10, 5 },
+		{ 8, 4 },
+	};
+	for (const auto &v : variants)
+	{
+		ChessRuleSet rules;
+		if (!GetChessRuleSet(v.boardSize, v.winLength, &rules))
+			continue;
+		const ChessRulesDynamic dynamic(v.boardSize, v.winLength);
+		vector<BenchGame> games;
+		RandomGames(v.boardSize, v.winLength, 256, 200, rng, games);
+		size_t moveCount = 0;
+		for (const BenchGame &g : games)
+			moveCount += g.moves.size();
+
+		// ּ𲽶
+		vector<char> board;
+		size_t mismatches = 0;
+		const size_t wins = ReplayGames(games, board, [&](char *b, int N, int input[], char player)
+		{
+			const bool specialized = rules.winDirection(rules, b, input[0], input[1], input[2], player) >= 0;
+			const bool generic = dynamic.winDirection(b, input[0], input[1], input[2], player) >= 0;
+			if (specialized != generic || (v.winLength == 5 && specialized != (CheckWin(N, b, input, player) != 0)))
+				mismatches++;
+			return specialized;
+		});
+		fprintf(stderr, "rules %d^3/%d (%s): %zu games, %zu moves, %zu wins\n", v.boardSize, v.winLength,
+		        rules.specialized ? "specialized" : "dynamic", games.size(), moveCount, wins);
+		if (mismatches > 0)
+			fprintf(stderr, "ERROR rule set %d^3/%d disagrees on %zu of %zu moves\n", v.boardSize, v.winLength, mismatches, moveCount);
+
+		volatile size_t sink = 0;
+		char name[64];
+		if (v.winLength == 5)
+		{
+			results.push_back(RunBench(cfg, "rules CheckWin/5", v.boardSize, -1.0, [&](uint64_t ops)
+			{
+				const uint64_t passes = max<uint64_t>(1, ops / moveCount);
+				for (uint64_t p = 0; p < passes; p++)
+					sink = sink + ReplayGames(games, board, [](char *b, int N, int input[], char player)
+				{
+					return CheckWin(N, b, input, player);
+				});
+				return passes * moveCount;
+			}));
+		}
+		snprintf(name, sizeof(name), "rules specialized/%d", v.winLength);
+		results.push_back(RunBench(cfg, name, v.boardSize, -1.0, [&](uint64_t ops)
+		{
+			const uint64_t passes = max<uint64_t>(1, ops / moveCount);
+			for (uint64_t p = 0; p < passes; p++)
+				sink = sink + ReplayGames(games, board, [&](char *b, int, int input[], char player)
+			{
+				return rules.winDirection(rules, b, input[0], input[1], input[2], player) >= 0;
+			});
+			return passes * moveCount;
+		}));
+		snprintf(name, sizeof(name), "rules dynamic/%d", v.winLength);
+		results.push_back(RunBench(cfg, name, v.boardSize, -1.0, [&](uint64_t ops)
+		{
+			const uint64_t passes = max<uint64_t>(1, ops / moveCount);
+			for (uint64_t p = 0; p < passes; p++)
+				sink = sink + ReplayGames(games, board, [&](char *b, int, int input[], char player)
+			{
+				return dynamic.winDirection(b, input[0], input[1], input[2], player) >= 0;
+			});
+			return passes * moveCount;
+		}));
+	}
+}
+
+int main(int argc, char **argv)
+{
+	const char *outPath = "bench-results.json";
+	const char *recordsPath = nullptr;
+	BenchConfig cfg;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--quick") == 0)
+			cfg.minMs = 20.0;
+		else if (strcmp(argv[i], "--records") == 0 && i + 1 < argc)
+			recordsPath = argv[++i];
+		else
+			outPath = argv[i];
+	}
+
+	// ⺯Ĵӡȫ
+#ifdef _WIN32
+	if (!freopen("NUL", "w", stdout))
+#else
+	if (!freopen("/dev/null", "w", stdout))
+#endif
+		fprintf(stderr, "warning: stdout not redirected, console output is included in timings\n");
+
+	const int sizes[] = { 5, 10, 20, 50, 100 };
+	const double densities[] = { 0.01, 0.1, 0.5, 0.9 };
+	vector<BenchResult> results;
+	mt19937_64 rng(20240601);
+	vector<int> empties, stones;
+
+	for (int N : sizes)
+	{
+		// place꣬ۼӷֹŻ
+		vector<int> coords(3 * 4096);
+		for (size_t i = 0; i < coords.size(); i++)
+			coords[i] = (int)(rng() % N) + 1;
+		volatile int sink = 0;
+		results.push_back(RunBench(cfg, "place", N, -1.0, [&](uint64_t batch)
+		{
+			int acc = 0;
+			for (uint64_t i = 0; i < batch; i++)
+			{
+				const int *c = &coords[(i % 4096) * 3];
+				acc += place(c[0], c[1], c[2], N);
+			}
+			sink = sink + acc;
+			return batch;
+		}));
+
+		// OnlineInitChessBoard䲢N^3ֽڣͷ
+		results.push_back(RunBench(cfg, "OnlineInitChessBoard", N, -1.0, [&](uint64_t batch)
+		{
+			for (uint64_t i = 0; i < batch; i++)
+			{
+				char *board = nullptr;
+				if (OnlineInitChessBoard(&board, N))
+					free(board);
+			}
+			return batch;
+		}));
+		results.back().mallocsPerOp = 1.0;
+
+		char *board = nullptr;
+		if (!OnlineInitChessBoard(&board, N))
+			return 1;
+		for (double density : densities)
+		{
+			FillBoard(board, N, density, rng, empties, stones);
+
+			// UpdateBoardStateڿλӣԱܶȲ
+			if (!empties.empty())
+			{
+				results.push_back(RunBench(cfg, "UpdateBoardState", N, density, [&](uint64_t batch)
+				{
+					int input[3];
+					for (uint64_t i = 0; i < batch; i++)
+					{
+						int cell = empties[i % empties.size()];
+						ToInput(cell, N, input);
+						UpdateBoardState(N, board, input, (i & 1) ? '2' : '1');
+						board[cell] = 0;
+					}
+					return batch;
+				}));
+			}
+
+			// CheckWinΪ
+			if (!stones.empty())
+			{
+				results.push_back(RunBench(cfg, "CheckWin", N, density, [&](uint64_t batch)
+				{
+					int input[3];
+					int wins = 0;
+					for (uint64_t i = 0; i < batch; i++)
+					{
+						int cell = stones[i % stones.size()];
+						ToInput(cell, N, input);
+						wins += CheckWin(N, board, input, board[cell]);
+					}
+					sink = sink + wins;
+					return batch;
+				}));
+			}
+		}
+		free(board);
+	}
+
+	vector<BenchGame> games;
+	if (recordsPath)
+	{
+		if (!LoadRecordGames(recordsPath, games))
+			return 1;
+	}
+	else
+	{
+		RandomGames(10, 5, 256, 200, rng, games);
+	}
+	BenchReplay(cfg, games, results);
+	BenchRules(cfg, rng, results);
+	BenchSparse(cfg, rng, results);
+
+	BenchDispatch(cfg, results);
+
+	WriteJson(outPath, results);
+	return 0;
+}
@@ -7,8 +7,13 @@
 #include <atomic>
 #include <thread>
 #include <chrono>
+#include <condition_variable>
 #include <functional>
+#include <memory>
 #include "LanP2PNode.h"
+#include "chess-bitboard.h"
+#include "chess-record.h"
+#include "MoveProvider.h"
 
 class Client
 {
@@ -33,6 +38,18 @@ class Client
 		std::string getMatchId() const;//ȡƥID
 		lanp2p::PeerInfo getMatchPeer() const;//ȡԶpeerinfo
 
+		void setEngineEnabled(bool enabled);//AIйܣӣ
+		bool isEngineEnabled() const;
+		void setEngineTimeMs(int ms);//AIÿ˼ʱ
+		void setEngineThreads(int threads);//AI߳<=0ʾʹȫ
+		void setEngineUseMcts(bool useMcts);//AIؿĬalpha-beta
+		bool isEngineUsingMcts() const;
+		void setEnginePonder(bool enabled);//AIڶԷ˼ʱ̨Ԥľ棨alpha-beta
+		bool isEnginePondering() const;
+		void setBookPath(const std::string &path);//AIѯĿֿ⣨chess-book.hַֻʾ
+		void setRecordPath(const std::string &path);//Ծּ¼ļchess-record.hַʾ¼
+		void setMoveProvider(const std::shared_ptr<MoveProvider> &provider);//ԶԴűԶ̵ȣһЧnullptrָ/AIй
+
 	private:
 		lanp2p::LanP2PNode &_node;//ͨŽڵ
 
@@ -61,14 +78,28 @@ class Client
 		std::thread _timeoutThread;
 		const std::chrono::seconds _requestTimeout{ 30 };
 
-		char *_chessBoard{ nullptr };//
+		ChessBitBoard _chessBoard;//̣λ̣
 		const int _boardSize{ 20 };//̴С
 		bool _myTurn{ false };
 		char _myPlayer{ '1' };//Ⱥ
 		std::atomic<bool> _gameRunning{ false };
 		bool _iAmMatchInitiator{ false };//ǷǷ
 
+		ConsoleMoveProvider _consoleMoves;
+		EngineMoveProvider _engineMoves;
+		std::atomic<bool> _engineEnabled{ false };
+		std::shared_ptr<MoveProvider> _customMoves;//ǿʱڼ/AIй
+		std::mutex _providerMutex;
+		std::shared_ptr<MoveProvider> _matchMoves;//ʹõԶԴ֤Ծڼ䲻ͷţ
+		MoveProvider *_moves{ nullptr };//ֵԴinitGameStateʱѡ
+
+		std::string _recordPath{ "c3-games.c3r" };//ÿֽʱ׷ӵļ
+		ChessRecordHeader _recordHeader{};
+		std::vector<ChessRecordMove> _recordMoves;
+		std::chrono::steady_clock::time_point _gameStart;
+
 		std::mutex _moveMutex;
+		std::condition_variable _moveCv;//ԷӵԾֱʱϷѭ
 		bool _opponentMoved{ false };//ԶǷ
 		int _opponentMove[3] { 0, 0, 0 };//Զ
 
@@ -85,4 +116,6 @@ class Client
 		void gameLoop();//ѭ
 		void initGameState();//ʼ
 		void cleanupGameState();//Դ
+		void recordMove(const int coords[], char player);//¼һǰԾ
+		void saveGameRecord();//ѵǰԾ׷ӵ¼ļ
 };
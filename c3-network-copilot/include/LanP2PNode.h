@@ -4,9 +4,11 @@
 #include <thread>
 #include <atomic>
 #include <mutex>
+#include <condition_variable>
 #include <unordered_map>
 #include <vector>
 #include <functional>
+#include <memory>
 #include <cstdint>
 
 namespace lanp2p
@@ -21,6 +23,8 @@ namespace lanp2p
 		uint64_t lastSeenMs{0};// һα/ʱ룩
 	};
 
+	struct FieldRef; // ֶ֡ΣLanP2PNode.cpp
+
 	// P2Pڵ㣺UDP֡TCPսϢշ
 	class LanP2PNode
 	{
@@ -104,36 +108,118 @@ namespace lanp2p
 				return _maxSendRetries;
 			}
 
+			// ֡ͷʽDirectڵֱ߳sendͻʱʣಿֽ¼ѭ̲߳ȵΪֹ
+			// Batched֡׷ӵӵķͶУ¼ѭÿֶÿӺϲһsendһڷͬһԶ˵Ķֻ֡ռһϵͳã
+			// ʱл¼ѭδʱBatchedDirect
+			// trueʾ֡ѽں˻ѽڵķͶУŶӵ֡ӶϿûзת벹У
+			// ά߳ԭ˳򲹷_maxSendRetriesΣʧWARN־
+			// Batched֤ʹҲ·֡ڵֹͣʱеֱ֡Ӷ
+			enum class IoMode
+			{
+				Direct,
+				Batched
+			};
+			void setIoMode(IoMode mode)
+			{
+				_ioMode = mode;
+			}
+			IoMode getIoMode() const
+			{
+				return _ioMode;
+			}
+
+			// Э飨ĬãHELLOЭ̣˫ֵ֧REQ/RESP/INT/HB/MOVEķϢ
+			// 벻ֵ֧ľɽڵ֮ıЭ飻ǷöܽնϢ
+			void setBinaryProtocol(bool enabled)
+			{
+				_binaryProtocol = enabled;
+			}
+			bool binaryProtocol() const
+			{
+				return _binaryProtocol;
+			}
+
+			// շͳƣ֡send/recvôHELLO
+			struct IoStats
+			{
+				uint64_t framesSent{0};
+				uint64_t sendCalls{0};
+				uint64_t framesReceived{0};
+				uint64_t recvCalls{0};
+			};
+			IoStats getIoStats() const;
+
 			// ƥбǶսԾ⣩
 			void markMatchActive(const std::string &ip, uint16_t tcpPort, const std::string &peerId, const std::string &matchId);
 
 			// ƥID16λʮַ
 			static std::string generateMatchId();
 
+			// ֱӷַһ֡ģǰ׺ͬremoteIpյڻ׼ط
+			// صڵִ߳У¼ѭ÷ַ״ֻ̬ڽڵδʱ
+			void injectFrame(const std::string &remoteIp, const char *data, size_t size);
+
 		private:
-			// ̺߳UDP㲥/TCPTCPӴά߳
+			// ̺߳UDP㲥/TCP¼ѭȫӣά߳
 			void udpBroadcastLoop();
 			void udpListenLoop();
-			void tcpListenLoop();
-			void tcpConnectionHandler(uintptr_t sock, std::string remoteIp);
+			void tcpEventLoop();
 			void peersMaintenanceLoop();
 
-			// TCP߽֡ķ/գǰ4ֽ򳤶ȣ
+			// TCP߽֡ķ/գǰ4ֽ򳤶ȣЭַ
+			struct Connection;
 			bool tcpSendFramed(uintptr_t sock, const std::string &payload);
-			bool tcpRecvFramed(uintptr_t sock, std::string &outPayload);
+			bool tcpReadFrames(const std::shared_ptr<Connection> &conn);
+			bool dispatchFrames(const std::shared_ptr<Connection> &conn, const char *data, size_t size, size_t &consumed);
+			void dispatchFrame(const std::shared_ptr<Connection> &conn, const char *data, size_t size);
+			void dispatchBinary(const std::shared_ptr<Connection> &conn, const char *data, size_t size);
+			std::string helloPayload() const;
+
+			// opcodeõĽıϢõ'|'кõֶΣϢõ
+			void onTextHello(const std::shared_ptr<Connection> &conn, const FieldRef *fields, size_t count);
+			void onTextRequest(const std::shared_ptr<Connection> &conn, const FieldRef *fields, size_t count);
+			void onTextResponse(const std::shared_ptr<Connection> &conn, const FieldRef *fields, size_t count);
+			void onTextInterrupt(const std::shared_ptr<Connection> &conn, const FieldRef *fields, size_t count);
+			void onTextHeartbeat(const std::shared_ptr<Connection> &conn, const FieldRef *fields, size_t count);
+			void onTextMove(const std::shared_ptr<Connection> &conn, const FieldRef *fields, size_t count);
+			void onBinaryRequest(const std::shared_ptr<Connection> &conn, const char *body);
+			void onBinaryResponse(const std::shared_ptr<Connection> &conn, const char *body);
+			void onBinaryInterrupt(const std::shared_ptr<Connection> &conn, const char *body);
+			void onBinaryHeartbeat(const std::shared_ptr<Connection> &conn, const char *body);
+			void onBinaryMove(const std::shared_ptr<Connection> &conn, const char *body);
+
+			// ϢĴıЭֶκã
+			void handleMatchRequest(const std::shared_ptr<Connection> &conn, const FieldRef &fromId, uint16_t fromPort,
+			                        const FieldRef &matchId, const FieldRef &toId);
+			void handleMatchResponse(const std::shared_ptr<Connection> &conn, const FieldRef &fromId, const FieldRef &matchId, bool accepted);
+			void handleMatchInterrupt(const std::shared_ptr<Connection> &conn, const FieldRef &fromId, const FieldRef &matchId);
+			void handleHeartbeat(const std::shared_ptr<Connection> &conn, const FieldRef &fromId, const FieldRef &matchId);
+			void handleGameMove(const std::shared_ptr<Connection> &conn, int x, int y, int z);
 
 			// ߷ʱID
 			static uint64_t nowMs();
 			static std::string randomId();
 
-			//  ip+id ҶԶTCP˿ڣص
-			uint16_t findPeerTcpPort(const std::string &ip, const std::string &id);
-
 			// ս״̬¼/ƥ估
 			void clearMatch(const std::string &ip, uint16_t tcpPort, const std::string &peerId, const std::string &matchId,
 			                bool notify);
+			void clearMatchByKey(const std::string &key, const std::string &ip, uint16_t tcpPort, const std::string &peerId,
+			                     const std::string &matchId, bool notify);
 			bool sendTcpHeartbeat(const std::string &ip, uint16_t port, const std::string &matchId);
 
+			// ӹȡãҪʱԶ˵ӡӷͣʧʱԣʧЧ
+			// ǼǴͶ/¼ѭСرգδ֡ת벹У/
+			std::shared_ptr<Connection> getConnection(const std::string &ip, uint16_t port);
+			bool sendToPeer(const std::string &ip, uint16_t port, const std::string &text, const std::string &binary);
+			bool sendFrame(const std::shared_ptr<Connection> &conn, const std::string &payload);
+			void dropConnection(const std::shared_ptr<Connection> &conn);
+			void scheduleFlush(const std::shared_ptr<Connection> &conn);
+			bool flushConnection(const std::shared_ptr<Connection> &conn);
+			void closeConnection(const std::shared_ptr<Connection> &conn);
+			void queueRetryFrames(const std::string &ip, uint16_t port, std::string &frames);
+			void resendRetryFrames();
+			void wakeReactor();
+
 		private:
 			// ˿ʶ
 			uint16_t _discoveryPort{0};
@@ -179,5 +265,60 @@ namespace lanp2p
 
 			// ʧʱԴ
 			int _maxSendRetries{3};
+
+			// ӣÿԶˣip:˿ڣһ˫֡ӣϢ͹
+			// ӵһȷHELLO֪Լļ˿ڣӷݴ˵ǼǣطϢҲ
+			struct Connection
+			{
+				uintptr_t sock{ ~(uintptr_t)0 };
+				std::string ip;
+				uint16_t port{ 0 };                  // ԶTCP˿ڣվյHELLOǰΪ0
+				std::mutex sendMutex;                // ̷߳ʱ֤֡
+				std::atomic<bool> closed{ false };
+				std::string inBuf;                   // յδ֡ݣֻ¼ѭʣ
+				std::string outBuf;                  // ¼ѭ֡sendMutexǿʱDirectҲŶӣ֤֡
+				size_t outHead{ 0 };                 // outBuf׵֡ѷֽsendMutex
+				uint64_t outSent{ 0 };               // outBufۼƷת벹УֽsendMutexDirectݴжԼ֡ѽ
+				std::condition_variable sendDone;    // outBufнչӹرʱ֪ͨȴDirectͷ
+				bool outQueued{ false };             // ѵǼǵ_flushConnsȴдsendMutex
+				bool wantWrite{ false };             // ͻȿдoutBufֻ¼ѭʣ
+				std::atomic<int> wireVersion{ 0 };   // Э̳ĶЭ汾0ʾıЭ
+			};
+			std::mutex _connMutex;
+			std::unordered_map<std::string, std::shared_ptr<Connection>> _connsByKey; // key: ip:portڷ
+			std::vector<std::shared_ptr<Connection>> _pendingConns;                    // ½δ¼ѭĳվ
+			uintptr_t _wakeSock{ ~(uintptr_t)0 };   // ¼ѭĻ׽֣_connMutex
+			uint16_t _wakePort{ 0 };
+			std::atomic<bool> _reactorReady{ false }; // ¼ѭУBatched
+			std::vector<std::shared_ptr<Connection>> _flushConns;                      // д֡ӣ_connMutex
+			// Ͽʱû֡󲹷_connMutexkey: ip:port
+			struct RetryFrames
+			{
+				std::string ip;
+				uint16_t port{ 0 };
+				std::string frames;
+				int attempts{ 0 };               // ά߳ʧܵĴ
+			};
+			std::unordered_map<std::string, RetryFrames> _retryFrames;
+			std::vector<char> _readBuf;             // ¼ѭĽջ壨ʱһΣӹã
+
+			// ַʱõʱֻ¼ѭ߳ʹãصдȶַٷڴ
+			struct DispatchScratch
+			{
+				std::string key;       // ip:port:id
+				std::string matchId;
+				PeerInfo peer;
+				char ids[3][16];       // ϢIDʮʽ
+			};
+			DispatchScratch _scratch;
+			std::shared_ptr<Connection> _injectConn; // injectFrameʹõ
+
+			// ͷʽЭ鿪շͳ
+			std::atomic<IoMode> _ioMode{ IoMode::Direct };
+			std::atomic<bool> _binaryProtocol{ true };
+			std::atomic<uint64_t> _framesSent{ 0 };
+			std::atomic<uint64_t> _sendCalls{ 0 };
+			std::atomic<uint64_t> _framesReceived{ 0 };
+			std::atomic<uint64_t> _recvCalls{ 0 };
 	};
 }
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include "chess-bitboard.h"
+#include "chess-engine.h"
+#include "chess-mcts.h"
+#include "chess-book.h"
+
+// ԴԾѭÿҪһ˫߳ÿһ֪ͨ
+// ClientÿֿʼʱѡԴԾڼ䲻NativeGetChessPositionԼ1ʼ
+class MoveProvider
+{
+	public:
+		virtual ~MoveProvider() {}
+
+		virtual const char *name() const = 0;
+		// ¶Ծֿʼ̴С뱾ִ
+		virtual void onGameStart(int boardSize, char myPlayer)
+		{
+			(void)boardSize;
+			(void)myPlayer;
+		}
+		// һfalseʾűꡢӶϿȣClientԾ
+		virtual bool getMove(const ChessBitBoard &board, char player, int coords[3]) = 0;
+		// һ䵽ҶԾּboardΪӺ̣
+		virtual void onMove(const ChessBitBoard &board, const int coords[3], char player)
+		{
+			(void)board;
+			(void)coords;
+			(void)player;
+		}
+		virtual void onGameEnd() {}
+};
+
+// 루NativeGetChessPosition
+class ConsoleMoveProvider : public MoveProvider
+{
+	public:
+		const char *name() const override
+		{
+			return "console";
+		}
+		bool getMove(const ChessBitBoard &board, char player, int coords[3]) override;
+};
+
+// AIйܣalpha-betaɲ鿪ֿ⡢ԷغϺ̨˼MCTSʱΪ
+class EngineMoveProvider : public MoveProvider
+{
+	public:
+		const char *name() const override
+		{
+			return "engine";
+		}
+		void onGameStart(int boardSize, char myPlayer) override;
+		bool getMove(const ChessBitBoard &board, char player, int coords[3]) override;
+		void onMove(const ChessBitBoard &board, const int coords[3], char player) override;
+		void onGameEnd() override;
+
+		void setTimeMs(int ms);
+		int timeMs() const
+		{
+			return _timeMs.load();
+		}
+		void setThreads(int threads);//<=0ʾʹȫ
+		void setUseMcts(bool useMcts);
+		bool usingMcts() const
+		{
+			return _useMcts.load();
+		}
+		void setPonder(bool enabled);//alpha-beta
+		bool pondering() const
+		{
+			return _ponder.load();
+		}
+		void setBookPath(const std::string &path);//ַʾÿֿ
+
+	private:
+		std::unique_ptr<ChessEngine> _engine;//״ʹʱ
+		std::atomic<int> _timeMs{ 2000 };
+		std::atomic<int> _threads{ 0 };
+		std::atomic<bool> _ponder{ false };
+		int _ponderMove[3] { 0, 0, 0 };//һԤĶԷӦ̨֣˼ʱЧ
+		bool _ponderHit{ false };//ԷʵԤһ£һֱȡ̨
+		ChessBook _book;//ֿ⣨״δʱ򿪣
+		std::string _bookPath{ "c3-book.bin" };
+		std::unique_ptr<ChessMcts> _mcts;//״ѡʱ
+		std::atomic<bool> _useMcts{ false };
+		std::vector<char> _mctsBoard;//MCTSʹõchar*
+		char _myPlayer{ '1' };
+
+		ChessEngineLimits limits() const;
+		void startPondering(const ChessBitBoard &board);//ӺԤĶԷӦ֮ʼ̨
+		void onOpponentMove(const int move[3]);//ԷӺʼʱֹ̨ͣ
+};
+
+// űļÿһ"x y z"Ҳöŷָ#ͷк
+// ÿִӵһ¿ʼߵļĩβgetMovefalse
+class ScriptedMoveProvider : public MoveProvider
+{
+	public:
+		explicit ScriptedMoveProvider(const std::string &path);
+
+		bool isLoaded() const
+		{
+			return !_moves.empty();
+		}
+		size_t moveCount() const
+		{
+			return _moves.size() / 3;
+		}
+		const char *name() const override
+		{
+			return "script";
+		}
+		void onGameStart(int boardSize, char myPlayer) override;
+		bool getMove(const ChessBitBoard &board, char player, int coords[3]) override;
+
+	private:
+		std::vector<int> _moves;//ÿ3һ
+		size_t _next{ 0 };
+};
+
+// Զ̿ƣͨTCPⲿսbotշı
+//   START <boardSize> <player> / MOVE <player> <x> <y> <z> / GO / END
+//   յÿGOһ"x y z"
+// ׾ֿʼʱָãϿһ
+class RemoteMoveProvider : public MoveProvider
+{
+	public:
+		RemoteMoveProvider(const std::string &host, uint16_t port, int timeoutMs = 0);//timeoutMs<=0ʾһֱȴ
+		~RemoteMoveProvider();
+
+		RemoteMoveProvider(const RemoteMoveProvider &) = delete;
+		RemoteMoveProvider &operator=(const RemoteMoveProvider &) = delete;
+
+		bool connect();
+		void disconnect();
+		bool isConnected() const
+		{
+			return _sock != ~(uintptr_t)0;
+		}
+		const char *name() const override
+		{
+			return "remote";
+		}
+		void onGameStart(int boardSize, char myPlayer) override;
+		bool getMove(const ChessBitBoard &board, char player, int coords[3]) override;
+		void onMove(const ChessBitBoard &board, const int coords[3], char player) override;
+		void onGameEnd() override;
+
+	private:
+		std::string _host;
+		uint16_t _port;
+		int _timeoutMs;
+		uintptr_t _sock{ ~(uintptr_t)0 };
+		std::string _recvBuf;//δȡߵĽ
+
+		bool sendLine(const std::string &line);
+		bool readLine(std::string &line);
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Уĵ룺ChessBoardOnlineInitChessBoard֣ᱻ޸ģplayerinput
+struct ChessBatchMove
+{
+	const char *ChessBoard;
+	int BoardSize;
+	int input[3];          // (x, y, z)1ʼ
+	char player;           // '1''2'
+};
+
+// UpdateBoardStateINVALID_MOVE֧һһӦ
+enum ChessBatchStatus : uint8_t
+{
+	ChessBatchLegal = 0,
+	ChessBatchOutOfRange = 1,
+	ChessBatchOccupied = 2,
+	ChessBatchBadPlayer = 3
+};
+
+struct ChessBatchResult
+{
+	uint8_t status;        // ChessBatchStatus
+	int8_t winDirection;   // ӺϷҳʱΪţChessDirectionsΪ-1
+};
+
+// жϺϷʤӡ̣resultsmovesһһӦ
+// threads>1ʱп鲢д<=0ʾʹȫģνСʱڵ߳
+void CheckMovesBatch(const ChessBatchMove *moves, size_t count, ChessBatchResult *results, int threads = 1);
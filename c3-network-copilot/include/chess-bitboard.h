@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "chess-game.h"
+#include "chess-lines.h"
+
+// λ̣ÿλһλƽ棬һռ1λ20^3ÿƽԼ2KB
+// xyĩβ4հףzǰ5հףʹ134ƫ
+// Խ紦Ϊ0ȫҪ߽ж
+struct ChessBitBoard
+{
+	int boardSize{ 0 };
+	int pitch{ 0 };                            // пBoardSize+4
+	int64_t layer{ 0 };                        // ĲСpitch*pitch
+	int64_t origin{ 0 };                       // (1,1,1)Ӧλ
+	int64_t strides[ChessDirectionCount] {};   // 13ǰһλƫƣΪ
+	std::vector<uint64_t> planes[2];           // planes[0]Ϊ'1'planes[1]Ϊ'2'
+	ChessLineCounters lines;                   // ߼̲ChessLineTableMaxSizeʱã
+};
+
+// ַλƽŻת
+inline int BitBoardPlane(char player)
+{
+	return player == '2' ? 1 : 0;
+}
+
+// ȡĳһλ
+inline bool BitBoardTest(const uint64_t *bits, int64_t index)
+{
+	return ((bits[index >> 6] >> (index & 63)) & 1ull) != 0;
+}
+
+int64_t BitBoardIndex(const ChessBitBoard &board, int x, int y, int z);
+bool OnlineInitBitBoard(ChessBitBoard *pBoard, int BoardSize);
+void FreeBitBoard(ChessBitBoard *pBoard);
+// ̵ͷڴ棨Ծָͬһ̣
+void ClearBitBoard(ChessBitBoard &board);
+char BitBoardAt(const ChessBitBoard &board, int x, int y, int z);
+void BitBoardToChars(const ChessBitBoard &board, char *ChessBoard);
+bool UpdateBitBoardState(ChessBitBoard &board, int input[], char player);
+int CheckWinBitBoard(const ChessBitBoard &board, int input[], char player);
+// UpdateBitBoardStateͬӡԶĵʹ
+bool BitBoardPlace(ChessBitBoard &board, const int input[], char player);
+
+// ӡļӿڣڷţChessDirections巵-1
+int BitBoardWinDirection(const ChessBitBoard &board, int64_t index, int plane);
+// ̼⣺λƽ13λ㣬ڻط/У浵
+bool BitBoardHasFive(const ChessBitBoard &board, char player);
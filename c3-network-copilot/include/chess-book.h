@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include "chess-mmap.h"
+
+// ֿ/оֻ棺ϵĿѰַϣļڴӳ䣬ʱκν
+// Ϊ淶ϣchess-symmetry.hԹ淶ĸŴţ48ȼ۾湲һ
+// ̿ͬʱֻͬһ⣨ҳ棩д뷽ͬһʱֻһ̣ڵдɻл
+// ȡϵļִǼֵͬûдһıʱУ鲻δ
+const uint32_t ChessBookMagic = 0x4B423343;     // "C3BK"
+const uint16_t ChessBookVersion = 2;
+
+struct ChessBookFileHeader
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t entryBytes;
+	uint32_t boardSize;
+	uint32_t reserved;
+	uint64_t slotCount;          // 2
+	uint64_t padding[5];         // ͷ64ֽ
+};
+
+// move/score/depthԶͳƣgames/points2
+// probe()صǽıļkeyλôǼ^ڶ^֣ȫΪ0ʾղ
+struct ChessBookEntry
+{
+	uint64_t key;                // 淶ϣ0ɹ̶ֵ
+	int32_t move;                // 淶ӣ-1ʾû
+	int16_t score;               // ֵӷӽǵķChessEngineResult::score
+	uint8_t depth;               // ó÷ȣ0ʾֻͳ
+	uint8_t flags;               // ChessBookSolved
+	uint32_t games;              // ӸþĶԾ
+	uint32_t points2;            // ֵӷĵ÷֡2ʤ210
+};
+
+// ־
+enum
+{
+	ChessBookSolved = 1          // ֤ʤĻվ֣޹
+};
+
+static_assert(sizeof(ChessBookFileHeader) == 64, "ChessBookFileHeader layout");
+static_assert(sizeof(ChessBookEntry) == 24, "ChessBookEntry layout");
+
+// ½տ⣨Ѵ򸲸ǣslotCountȡΪ2
+bool CreateChessBook(const char *path, int BoardSize, uint64_t slotCount);
+
+class ChessBook
+{
+	public:
+		bool open(const char *path, bool writable = false);
+		void close()
+		{
+			_file.close();
+			_entries = nullptr;
+			_mask = 0;
+			_boardSize = 0;
+		}
+		bool isOpen() const
+		{
+			return _entries != nullptr;
+		}
+		bool writable() const
+		{
+			return _file.writable();
+		}
+		int boardSize() const
+		{
+			return _boardSize;
+		}
+
+		bool probe(uint64_t key, ChessBookEntry &entry) const;
+		// ¼иĽʱ
+		bool store(uint64_t key, int move, int score, int depth, int flags = 0);
+		// ¼һֵĽpoints2ֵӷʤ210
+		bool addResult(uint64_t key, int points2);
+
+	private:
+		// ӳڴеһ64λԭӷʣChessBookEntryͬ
+		struct Slot
+		{
+			std::atomic<uint64_t> check;
+			std::atomic<uint64_t> data;
+			std::atomic<uint64_t> stats;
+		};
+		static_assert(sizeof(Slot) == sizeof(ChessBookEntry), "ChessBook::Slot layout");
+
+		ChessMappedFile _file;
+		std::mutex _writeMutex;
+		Slot *_entries{ nullptr };
+		uint64_t _mask{ 0 };
+		int _boardSize{ 0 };
+
+		Slot *findSlot(uint64_t key, int depth, ChessBookEntry &entry);
+		void write(Slot &slot, const ChessBookEntry &entry);
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// ѡ㼯ϣһӵбѩ벻radiusĿλ/ά
+// ֻ¸øΧ(2*radius+1)^3򣬼ϵļɾO(1)±+ĩβ
+// place()һ
+struct ChessCandidates
+{
+	int boardSize{ 0 };
+	int radius{ 1 };
+	std::vector<int32_t> cells;         // ǰѡ㣨
+	std::vector<int32_t> slot;          // slot[c]ccellsе±꣬ڼΪ-1
+	std::vector<uint16_t> coverage;     // coverage[c]radiusڵ
+	std::vector<uint8_t> occupied;
+	std::vector<int8_t> offsets;        // ƫ(dx, dy, dz)ÿ3һ飬(0, 0, 0)
+};
+
+bool InitCandidates(ChessCandidates *pCandidates, int BoardSize, int radius);
+void FreeCandidates(ChessCandidates *pCandidates);
+// cellӣcellƳϣڵĿλ뼯
+void CandidatesPlace(ChessCandidates &candidates, int cell);
+// cellϵӣCandidatesPlaceϸʱָԭϣԪ˳ܲͬ
+void CandidatesRemove(ChessCandidates &candidates, int cell);
+
+inline bool CandidatesContains(const ChessCandidates &candidates, int cell)
+{
+	return candidates.slot[cell] >= 0;
+}
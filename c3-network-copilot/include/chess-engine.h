@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "chess-bitboard.h"
+#include "chess-book.h"
+
+// ƣһ㼴ֹͣ
+struct ChessEngineLimits
+{
+	int maxDepth{ 32 };          // 
+	int timeMs{ 2000 };          // ˼ʱ䣨룩<=0ʾ
+	uint64_t maxNodes{ 0 };      // ڵ0ʾ
+	int maxCandidates{ 24 };     // Ǹڵֻǰɸѡ
+	int threads{ 1 };            // ߳Lazy SMPû<=0ʾʹȫ
+	uint64_t vcfNodes{ 20000 };  // ǰıʤSolveThreatSpaceĽڵԤ㣬0ʾ
+	int bookMinDepth{ 4 };       // ֿȲڴֵ֤ʤҲmaxDepthĽֱӲãҲֻдȲڴֵĽ
+	bool patternEval{ false };   // ҶμPositionTrackPatternsPatternEvalScoreÿڵɨ13ֱ
+};
+
+// NativeGetChessPosition(x, y, z)Լ1ʼ
+struct ChessEngineResult
+{
+	int move[3] { 0, 0, 0 };
+	int score{ 0 };              // ӷӽǵķֵӽChessEngine::WinScoreʾʤ
+	int depth{ 0 };              // ɵĵ
+	uint64_t nodes{ 0 };         // ȫ̵߳Ľڵ֮
+	uint64_t elapsedMs{ 0 };
+	std::vector<uint64_t> threadNodes;  // ÿ̵߳Ľڵ[0]Ϊ̣߳
+	std::vector<uint64_t> threadNps;    // ÿ̵߳ÿڵ
+	bool fromBook{ false };      // ȡԿֿ⣬û
+	int ponderMove[3] { 0, 0, 0 };  // ԤĶԷӦ֣ȡûstartPonderԤʱȫΪ0
+};
+
+// AIalpha-beta + Zobristû + ɱ/ʷ
+// ߳ʱ̶߳ͬһ桢ͨû֦Lazy SMPȡ߳
+// ʤж߼費ChessLineTableMaxSize
+class ChessEngine
+{
+	public:
+		static const int WinScore = 30000;
+		static const int MaxPly = 64;
+
+		explicit ChessEngine(size_t ttMegabytes = 64);
+		~ChessEngine();
+
+		ChessEngine(const ChessEngine &) = delete;
+		ChessEngine &operator=(const ChessEngine &) = delete;
+
+		// Ϊplayerѡӣ޷false
+		bool chooseMove(const ChessBitBoard &board, char player, const ChessEngineLimits &limits, ChessEngineResult &result);
+		// ڽе췵أɿ̵߳ã
+		void stop();
+
+		// ̨˼Է˼ڼ䣬ں̨߳ϲʱboardͨ߳ԤӦֺľ棩playerΪ
+		// ԷʵӺԤһµponderHitʼʱfinishPonderȡһµstopPonder
+		// ̨˼ʱûۣʹԤգchooseMoveҲܸ
+		void startPonder(const ChessBitBoard &board, char player, const ChessEngineLimits &limits);
+		// ԤУ̨˼timeMs루<=0ʾֱﵽȣ
+		void ponderHit(int timeMs);
+		// ȴ̨ȡýûк̨ʱfalse
+		bool finishPonder(ChessEngineResult &result);
+		// Ԥգֹ̨ͣ
+		void stopPonder();
+		bool isPondering() const
+		{
+			return _ponderThread.joinable();
+		}
+		// ûʷ¶Ծʱã
+		void clear();
+		// ǰѯĿֿ/оֻ棨nullptrʾãԿдʽʱдؿ
+		// ɵ÷Уʹڼ䱣ִ
+		void setBook(ChessBook *book);
+
+	private:
+		struct SearchState;//̵߳˽״̸̬ѡ㡢ɱ/ʷ
+
+		// ûdataӡ߽
+		// ߳дʱkey^dataȡʱУ飬˺дıУʧܱδ
+		struct TTEntry
+		{
+			std::atomic<uint64_t> check{ 0 };
+			std::atomic<uint64_t> data{ 0 };
+		};
+		std::unique_ptr<TTEntry[]> _tt;
+		uint64_t _ttMask{ 0 };
+
+		std::atomic<bool> _stop{ false };
+		std::atomic<uint64_t> _totalNodes{ 0 };
+		std::atomic<int64_t> _deadlineNs{ INT64_MAX };  // steady_clock룬INT64_MAXʾʱponderHit޸ģԭһη
+		uint64_t _maxNodes{ 0 };
+		int _maxCandidates{ 24 };
+		int _boardSize{ 0 };
+		ChessBook *_book{ nullptr };
+
+		std::thread _ponderThread;
+		ChessBitBoard _ponderBoard;
+		ChessEngineResult _ponderResult;
+		bool _ponderOk{ false };
+
+		void armLimits(const ChessEngineLimits &limits);
+		void setDeadline(int timeMs);
+		bool runSearch(const ChessBitBoard &board, char player, const ChessEngineLimits &limits, ChessEngineResult &result);
+		void fillPonderMove(SearchState &s, ChessEngineResult &result);
+		bool probeBook(const SearchState &s, int minDepth, int maxDepth, ChessEngineResult &result) const;
+		void storeBook(const SearchState &s, const ChessEngineResult &result, int minDepth, bool solved);
+		void searchThread(SearchState &s, int threadIndex, int maxDepth, ChessEngineResult *result);
+		void clearTT();
+		int search(SearchState &s, int depth, int ply, int alpha, int beta);
+		int evaluate(const SearchState &s) const;
+		void generateMoves(SearchState &s, int ply, int ttMove, std::vector<int32_t> &moves);
+		bool checkLimits(SearchState &s);
+
+		bool probeTT(uint64_t key, int depth, int ply, int alpha, int beta, int &score, int &move) const;
+		void storeTT(uint64_t key, int depth, int ply, int score, int bound, int move);
+};
@@ -1,7 +1,27 @@
 #pragma once
 
+#include <cstdint>
+
+// 13CheckWinļ˳һ£xyzᣬxyyzxzƽĸԽߣԼռԽ
+// Ϊconstexprchess-rules.hڱڼ㲽
+const int ChessDirectionCount = 13;
+constexpr int ChessDirections[ChessDirectionCount][3] =
+{
+	{ 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 },
+	{ 1, 1, 0 }, { -1, 1, 0 },
+	{ 0, 1, 1 }, { 0, -1, 1 },
+	{ 1, 0, 1 }, { -1, 0, 1 },
+	{ 1, 1, 1 }, { -1, 1, 1 }, { 1, -1, 1 }, { -1, -1, 1 }
+};
+extern const char *const ChessDirectionNames[ChessDirectionCount];
+
 int place(int x, int y, int z, int BoardSize);
 bool OnlineInitChessBoard(char **pChessBoard, int BoardSize);
 void NativeGetChessPosition(int input[]);
-bool UpdateBoardState(int BoardSize, char *ChessBoard, int input[], char player);
+struct ChessCandidates;
+// pCandidatesǿʱӳɹͬºѡ㼯ϣchess-candidates.h
+bool UpdateBoardState(int BoardSize, char *ChessBoard, int input[], char player, ChessCandidates *pCandidates = nullptr);
 int CheckWin(int BoardSize, char *ChessBoard, int input[], char player);
+
+// windows[d]ĵkλʾdƫk-4ǷΪӣصһķ򷵻-1
+int FindFiveDirection(const uint32_t windows[ChessDirectionCount]);
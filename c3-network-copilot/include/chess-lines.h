@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "chess-game.h"
+
+// óߴʱ߱40^3Լ67ߣٽ
+const int ChessLineTableMaxSize = 40;
+
+// ߱г5ߣԼÿӵߣÿ̴СֻһΣ
+// place()һ£0ʼ
+struct ChessLineTable
+{
+	int boardSize{ 0 };
+	int lineCount{ 0 };
+	std::vector<int32_t> lineCells;     // iߵ5ӣlineCells[i*5 .. i*5+4]
+	std::vector<uint8_t> lineDirs;      // iߵķChessDirectionsţ
+	std::vector<int32_t> cellOffsets;   // cΪ cellLines[cellOffsets[c] .. cellOffsets[c+1])
+	std::vector<int32_t> cellLines;
+};
+
+// ȡãҪʱĳһߴ̰߱߳ȫChessLineTableMaxSizenullptr
+const ChessLineTable *GetChessLineTable(int BoardSize);
+
+// ÿ˫
+// open[p][k]pkҶԷûӵԿġߡֱʹ
+struct ChessLineCounters
+{
+	const ChessLineTable *table{ nullptr };
+	std::vector<uint8_t> counts;        // counts[line*2+plane]
+	int open[2][6] {};
+};
+
+bool InitLineCounters(ChessLineCounters *pCounters, int BoardSize);
+void FreeLineCounters(ChessLineCounters *pCounters);
+// /ֻ¾øߣӺ5true
+bool LineCountersPlace(ChessLineCounters &counters, int cell, int plane);
+void LineCountersRemove(ChessLineCounters &counters, int cell, int plane);
+// ɨֻ̣鿴øߣ巽ţ򷵻-1
+int LineCountersWinDirection(const ChessLineCounters &counters, int cell, int plane);
@@ -0,0 +1,61 @@
+#pragma once
+
+// 첽־ֻ߳Ѹʽõһд̵߳Ļλ壨ߵߣ
+// ɺ̨̰߳ȫźϲ̵߳ļ¼дstdout÷ڻԾ߼ȿ̨I/O
+// ʱ¼¼÷ChessLogLineMaxĲֱض
+enum ChessLogLevel
+{
+	ChessLogDebug = 0,
+	ChessLogInfo,
+	ChessLogWarn,
+	ChessLogError,
+	ChessLogOff
+};
+
+// ڸüCHESS_LOG_*ڱȥҲֵReleaseĬȥDebug
+#ifndef CHESS_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define CHESS_LOG_MIN_LEVEL 1
+#else
+#define CHESS_LOG_MIN_LEVEL 0
+#endif
+#endif
+
+const int ChessLogLineMax = 240;
+
+#if defined(__GNUC__)
+#define CHESS_LOG_PRINTF(a, b) __attribute__((format(printf, a, b)))
+#else
+#define CHESS_LOG_PRINTF(a, b)
+#endif
+
+// printfβҪз
+void ChessLogWrite(int level, const char *format, ...) CHESS_LOG_PRINTF(2, 3);
+// ڼĬChessLogDebugֻܱڼƣ
+void ChessLogSetLevel(int level);
+int ChessLogGetLevel();
+// ȴʱдļ¼ȫʾǰã֤ʾ֮ǰ־֮
+void ChessLogFlush();
+// 򻺳ļ¼
+unsigned long long ChessLogDropped();
+
+#if CHESS_LOG_MIN_LEVEL <= 0
+#define CHESS_LOG_DEBUG(...) ChessLogWrite(ChessLogDebug, __VA_ARGS__)
+#else
+#define CHESS_LOG_DEBUG(...) ((void)0)
+#endif
+#if CHESS_LOG_MIN_LEVEL <= 1
+#define CHESS_LOG_INFO(...) ChessLogWrite(ChessLogInfo, __VA_ARGS__)
+#else
+#define CHESS_LOG_INFO(...) ((void)0)
+#endif
+#if CHESS_LOG_MIN_LEVEL <= 2
+#define CHESS_LOG_WARN(...) ChessLogWrite(ChessLogWarn, __VA_ARGS__)
+#else
+#define CHESS_LOG_WARN(...) ((void)0)
+#endif
+#if CHESS_LOG_MIN_LEVEL <= 3
+#define CHESS_LOG_ERROR(...) ChessLogWrite(ChessLogError, __VA_ARGS__)
+#else
+#define CHESS_LOG_ERROR(...) ((void)0)
+#endif
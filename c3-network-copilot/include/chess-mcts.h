@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// ؿ
+struct ChessMctsLimits
+{
+	int timeMs{ 2000 };              // ˼ʱ䣨룩<=0ʾޣʱmaxPlayouts
+	uint64_t maxPlayouts{ 0 };       // ģ0ʾ
+	int threads{ 1 };                // ͬһ߳<=0ʾʹȫ
+	int maxPlayoutMoves{ 200 };      // ģ
+};
+
+// NativeGetChessPosition(x, y, z)Լ1ʼ
+struct ChessMctsResult
+{
+	int move[3] { 0, 0, 0 };
+	double winRate{ 0.0 };                  // ѡӵƽ÷֣ʤ10.50
+	uint64_t playouts{ 0 };
+	uint64_t elapsedMs{ 0 };
+	uint64_t treeNodes{ 0 };
+	std::vector<uint64_t> threadPlayouts;   // ÿ߳ɵģ
+	std::vector<uint64_t> threadPps;        // ÿ߳ÿģ
+};
+
+// MCTSѡ㣺̹߳һУʱʧ̼߳ͬһ֧
+// ģԾڴڱ߿˽ϽУʤжϲӡڴ
+class ChessMcts
+{
+	public:
+		explicit ChessMcts(size_t maxTreeNodes = 1 << 19);
+		~ChessMcts();
+
+		ChessMcts(const ChessMcts &) = delete;
+		ChessMcts &operator=(const ChessMcts &) = delete;
+
+		// ΪOnlineInitChessBoarḍֵfalse
+		bool chooseMove(const char *ChessBoard, int BoardSize, char player, const ChessMctsLimits &limits,
+		                ChessMctsResult &result);
+		// ڽе췵أɿ̵߳ã
+		void stop();
+
+	private:
+		struct Node;
+		struct Worker;
+
+		std::unique_ptr<Node[]> _nodes;
+		size_t _capacity{ 0 };
+		std::atomic<size_t> _used{ 0 };
+		std::atomic<bool> _stop{ false };
+		std::atomic<uint64_t> _playouts{ 0 };
+
+		int _boardSize{ 0 };
+		int _pitch{ 0 };                 // ߺпBoardSize+8
+		int64_t _layer{ 0 };
+		int64_t _strides[13] {};         // 13ڲϵһƫ
+		int _neighbors[26] {};           // 26ڸƫ
+		int _maxPlayoutMoves{ 200 };
+
+		int expand(Worker &w, int nodeIndex);
+		void runWorker(Worker &w, uint64_t maxPlayouts, std::chrono::steady_clock::time_point deadline, bool hasDeadline);
+		double playout(Worker &w);
+		bool isFive(const char *board, int64_t cell, char who) const;
+		int64_t toPadded(int cell) const;
+		int toCell(int64_t padded) const;
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+
+// ļڴӳ䣨WindowsCreateFileMapping/MapViewOfFileƽ̨mmap
+// дӳΪӳ䣬д뾭ҳͬʱӳļɼ
+
+// ʷʽʾ˳¼ļϵͳӴԤ̽⣨ϣصԤ
+enum ChessMapAccess
+{
+	ChessMapNormal,
+	ChessMapSequential,
+	ChessMapRandom
+};
+
+class ChessMappedFile
+{
+	public:
+		ChessMappedFile();
+		~ChessMappedFile();
+
+		ChessMappedFile(const ChessMappedFile &) = delete;
+		ChessMappedFile &operator=(const ChessMappedFile &) = delete;
+
+		// ļѴڣļ򿪳ɹdata()Ϊnullptr
+		bool open(const char *path, bool writable = false, ChessMapAccess access = ChessMapNormal);
+		void close();
+
+		uint8_t *data() const
+		{
+			return _data;
+		}
+		uint64_t size() const
+		{
+			return _size;
+		}
+		bool writable() const
+		{
+			return _writable;
+		}
+
+	private:
+		uint8_t *_data{ nullptr };
+		uint64_t _size{ 0 };
+		bool _writable{ false };
+		void *_file{ nullptr };      // Windowsļӳƽ̨δʹ
+		void *_mapping{ nullptr };
+};
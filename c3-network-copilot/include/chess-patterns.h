@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "chess-game.h"
+#include "chess-lines.h"
+
+// Σĳһڵֱжϣ_ΪλXΪ߽ԷΪ赲
+enum ChessPattern
+{
+	PatternOpenTwo = 0,      // _XX__X_X_ռԷչɻ
+	PatternOpenThree,        // _XXX_һٶһգ_X_XX__XX_X_һɻ
+	PatternFour,             // XXXXֻһ˿ɳ壨ģ
+	PatternBrokenFour,       // X_XXXXX_XXXXX_XмĿλ
+	PatternOpenFour,         // _XXXX_˶ܳ
+	PatternFive,
+	ChessPatternCount
+};
+
+extern const char *const ChessPatternNames[ChessPatternCount];
+
+// ֱ߱13Ϲᴩ̵ÿһֱߣȲ5ĲƣԼÿڵֱ
+struct ChessRayTable
+{
+	int boardSize{ 0 };
+	int rayCount{ 0 };
+	std::vector<int32_t> rayStart;      // ӣplace()ţ
+	std::vector<int32_t> rayStride;     // ֱǰһŲ
+	std::vector<uint8_t> rayLength;
+	std::vector<int32_t> cellRays;      // cellRays[cell*13+d]øڷdֱߣΪ-1
+};
+
+// GetChessLineTableͬߴ绺棬̰߳ȫChessLineTableMaxSizenullptr
+const ChessRayTable *GetChessRayTable(int BoardSize);
+
+// μ/ʱֻɨ辭ø13ֱ
+// ÿֱ߻һεļʱȼֵټֵ˳һȷ
+struct ChessPatternEval
+{
+	const ChessRayTable *table{ nullptr };
+	std::vector<uint8_t> board;         // 0Ϊգ1/2Ϊ'1'/'2'
+	std::vector<uint8_t> rayCounts;     // rayCounts[(ray*2+plane)*ChessPatternCount+k]
+	int counts[2][ChessPatternCount] {};
+};
+
+bool InitPatternEval(ChessPatternEval *pEval, int BoardSize);
+void FreePatternEval(ChessPatternEval *pEval);
+void PatternEvalPlace(ChessPatternEval &eval, int cell, int plane);
+void PatternEvalRemove(ChessPatternEval &eval, int cell);
+// planeΪӽǵη֣μȨͼȥԷ
+int PatternEvalScore(const ChessPatternEval &eval, int plane);
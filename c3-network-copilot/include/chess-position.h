@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "chess-candidates.h"
+#include "chess-lines.h"
+#include "chess-patterns.h"
+#include "chess-symmetry.h"
+
+// ջеһʱ״̬
+struct ChessPositionMove
+{
+	int32_t cell;
+	uint8_t plane;
+	bool five;                          // һǷ
+};
+
+// ѡά״̬InitPositiontrackɰλϣ
+enum
+{
+	PositionTrackPatterns = 1,          // ChessPatternEvalμÿԼ༸΢룩
+	PositionTrackSymmetry = 2           // 48ԳƾĹϣPositionCanonicalHashÿ48
+};
+
+// ɻľ棺 + ߼ + ѡ + μ + Zobristϣ + ջ
+// PositionMake/PositionUnmakeֻӸصĲ֣ø/ֱߡ򣩣̴С޹أ
+// 塢϶ҪBoardSize^3
+// place()һ£board0Ϊգ1/2Ϊ'1'/'2'費ChessLineTableMaxSize
+struct ChessPosition
+{
+	int boardSize{ 0 };
+	int cells{ 0 };
+	std::vector<char> board;
+	ChessLineCounters lines;
+	ChessCandidates candidates;
+	ChessPatternEval patterns;          // PositionTrackPatternsʱά
+	int track{ 0 };
+	const uint64_t *keys{ nullptr };
+	uint64_t hash{ 0 };
+	const int32_t *symmetry{ nullptr }; // PositionTrackSymmetryʱǿգGetChessSymmetryTable
+	ChessSymmetricHash symmetricHash;
+	int side{ 0 };                      // ֵӵһ0Ϊ'1'
+	int fives{ 0 };                     // ջĲ>0ʾѷֳʤ
+	int loaded{ 0 };                    // ջPositionLoadЩܻ
+	std::vector<ChessPositionMove> moves;
+};
+
+// candidateRadiusInitCandidatestrackΪPositionTrack*
+bool InitPosition(ChessPosition *pPosition, int BoardSize, int candidateRadius = 1, int track = 0);
+void FreePosition(ChessPosition *pPosition);
+// ɵǰֵһcellӲѹջ巵truecellΪ
+bool PositionMake(ChessPosition &position, int cell);
+// ָӷʱʹãӺֵԷ
+bool PositionMakeAs(ChessPosition &position, int cell, int plane);
+// ջһûпɻڵĲfalse
+bool PositionUnmake(ChessPosition &position);
+// ֻʣply϶
+void PositionRewind(ChessPosition &position, int ply);
+// պַ̣'1'/'2'/0룻sideΪֵӵһ
+bool PositionLoad(ChessPosition &position, const char *ChessBoard, int side);
+
+// 淶ϣChessCanonicalHashδάԳƹϣʱͨϣ*pSymΪ0
+uint64_t PositionCanonicalHash(const ChessPosition &position, int *pSym = nullptr);
+
+// ֮˶ٲ
+inline int PositionPly(const ChessPosition &position)
+{
+	return (int)position.moves.size() - position.loaded;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "chess-mmap.h"
+
+// Ծּ¼ĶƸʽļ¼βɣÿ¼ = ͷ + moveCount
+// ֶСȻ루ͷ48ֽڣ8ֽڣȡʱֱӰӳڴ浱ṹʹ
+const uint32_t ChessRecordMagic = 0x52473343;   // "C3GR"
+const uint16_t ChessRecordVersion = 1;
+
+// Ծֽ
+enum
+{
+	ChessRecordUnfinished = 0,   // жϻδʤ
+	ChessRecordPlayer1Wins = 1,
+	ChessRecordPlayer2Wins = 2
+};
+
+struct ChessRecordHeader
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t headerBytes;        // ͷʵʳȣȡݴԺֶ
+	uint64_t matchId;            // 16λʮƵƥIDֵ
+	uint64_t peerIds[2];         // [0]Ϊƥ䷢ߣ[1]ΪӦߣڵIDֵͬţ
+	uint64_t startUnixMs;        // Ծֿʼʱ䣨Unix룩
+	uint32_t moveCount;
+	uint8_t boardSize;
+	uint8_t firstPeer;           // ִ'1'ֵһpeerIdsе±
+	uint8_t result;              // ChessRecordUnfinished / Player1Wins / Player2Wins
+	uint8_t reserved;
+};
+
+struct ChessRecordMove
+{
+	uint8_t x, y, z;             // ꣬1ʼNativeGetChessPositionԼ
+	uint8_t player;              // '1''2'
+	uint32_t timeMs;             // Ծֿʼĺ
+};
+
+static_assert(sizeof(ChessRecordHeader) == 48, "ChessRecordHeader layout");
+static_assert(sizeof(ChessRecordMove) == 8, "ChessRecordMove layout");
+
+// 16λʮIDֵתǷַõ0
+uint64_t ChessRecordParseId(const std::string &id);
+std::string ChessRecordFormatId(uint64_t id);
+
+// ļĩβ׷һ¼header.moveCountӣmagic/version/headerBytesɱд
+bool AppendChessRecord(const char *path, ChessRecordHeader header, const ChessRecordMove *moves);
+
+// ¼ļֻڴӳ䣺ļӳַռ䣬ʱֱӷָӳڴָ룬κθ
+// GBļҪ64λ
+class ChessRecordArchive
+{
+	public:
+		bool open(const char *path)
+		{
+			return _file.open(path, false, ChessMapSequential);
+		}
+		void close()
+		{
+			_file.close();
+		}
+
+		const uint8_t *data() const
+		{
+			return _file.data();
+		}
+		uint64_t size() const
+		{
+			return _file.size();
+		}
+
+		// ȡoffsetļ¼offsetƵһĩβ¼𻵻򱻽ضϣд;ʱfalse
+		// ÷uint64_t off = 0; while (archive.next(off, h, m)) { ... }
+		bool next(uint64_t &offset, const ChessRecordHeader *&header, const ChessRecordMove *&moves) const;
+
+	private:
+		ChessMappedFile _file;
+};
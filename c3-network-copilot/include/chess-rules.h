@@ -0,0 +1,148 @@
+#pragma once
+
+#include <utility>
+#include "chess-game.h"
+
+// ̱߳SizeWinLengthΪ5Ҳ8^3ϵȱ壩
+// ģ汾ı߳ȫǱڳ±Ӽⶼᱻȫչ
+// ߴChessRulesDynamicӿͬplace()Լxyz1ʼ
+template <int Size, int WinLength>
+struct ChessRules
+{
+	static_assert(Size >= 1 && Size <= 1000, "board size out of range");
+	static_assert(WinLength >= 2 && WinLength <= 32, "win length out of range");
+
+	static constexpr int boardSize()
+	{
+		return Size;
+	}
+	static constexpr int winLength()
+	{
+		return WinLength;
+	}
+	static constexpr int cells()
+	{
+		return Size * Size * Size;
+	}
+	static constexpr int index(int x, int y, int z)
+	{
+		return (x - 1) + (y - 1) * Size + (z - 1) * Size * Size;
+	}
+	static constexpr int stride(int d)
+	{
+		return ChessDirections[d][0] + ChessDirections[d][1] * Size + ChessDirections[d][2] * Size * Size;
+	}
+	static constexpr bool inside(int x, int y, int z)
+	{
+		return x >= 1 && x <= Size && y >= 1 && y <= Size && z >= 1 && z <= Size;
+	}
+
+	// DϾ(x, y, z)ͬɫWinLength
+	// 뷽ǳΪ0겻߽ж
+	template <int D>
+	static int runLength(const char *ChessBoard, int x, int y, int z, char player)
+	{
+		const int dx = ChessDirections[D][0], dy = ChessDirections[D][1], dz = ChessDirections[D][2];
+		const int step = stride(D);
+		const int center = index(x, y, z);
+		int run = 1;
+		for (int k = 1; k < WinLength; k++)
+		{
+			if (!inside(x + k * dx, y + k * dy, z + k * dz) || ChessBoard[center + k * step] != player)
+				break;
+			run++;
+		}
+		for (int k = 1; k < WinLength && run < WinLength; k++)
+		{
+			if (!inside(x - k * dx, y - k * dy, z - k * dz) || ChessBoard[center - k * step] != player)
+				break;
+			run++;
+		}
+		return run;
+	}
+
+	// WinLengthӵķţChessDirections򷵻-1
+	static int winDirection(const char *ChessBoard, int x, int y, int z, char player)
+	{
+		return winDirection(ChessBoard, x, y, z, player, std::make_integer_sequence<int, ChessDirectionCount>());
+	}
+
+	template <int... D>
+	static int winDirection(const char *ChessBoard, int x, int y, int z, char player, std::integer_sequence<int, D...>)
+	{
+		int dir = -1;
+		// ˳չҵ·
+		int expand[] = { (dir < 0 && runLength<D>(ChessBoard, x, y, z, player) >= WinLength ? (dir = D) : 0)... };
+		(void)expand;
+		return dir;
+	}
+};
+
+// ʱߴͬӿڰ汾ûػĳߴ
+struct ChessRulesDynamic
+{
+	int size;
+	int win;
+
+	ChessRulesDynamic(int BoardSize, int WinLength) : size(BoardSize), win(WinLength)
+	{
+	}
+
+	int boardSize() const
+	{
+		return size;
+	}
+	int winLength() const
+	{
+		return win;
+	}
+	int cells() const
+	{
+		return size * size * size;
+	}
+	int index(int x, int y, int z) const
+	{
+		return place(x, y, z, size);
+	}
+	int stride(int d) const
+	{
+		return ChessDirections[d][0] + ChessDirections[d][1] * size + ChessDirections[d][2] * size * size;
+	}
+	bool inside(int x, int y, int z) const
+	{
+		return x >= 1 && x <= size && y >= 1 && y <= size && z >= 1 && z <= size;
+	}
+	int winDirection(const char *ChessBoard, int x, int y, int z, char player) const;
+};
+
+// ػĹ򼯺ϣChessRulesDynamic
+// fԹΪһΣfڲ㷨ֻǵμ⣩ᰴߴʵ
+template <class F>
+void DispatchChessRules(int BoardSize, int WinLength, F &&f)
+{
+	if (BoardSize == 20 && WinLength == 5)
+		f(ChessRules<20, 5>());
+	else if (BoardSize == 15 && WinLength == 5)
+		f(ChessRules<15, 5>());
+	else if (BoardSize == 10 && WinLength == 5)
+		f(ChessRules<10, 5>());
+	else if (BoardSize == 9 && WinLength == 5)
+		f(ChessRules<9, 5>());
+	else if (BoardSize == 8 && WinLength == 4)
+		f(ChessRules<8, 4>());
+	else
+		f(ChessRulesDynamic(BoardSize, WinLength));
+}
+
+// ʹģĵ÷ߴȡһκָ룬֮ÿμֻһμӵ
+struct ChessRuleSet
+{
+	int boardSize{ 0 };
+	int winLength{ 0 };
+	bool specialized{ false };   // Ƿбػ
+	int (*winDirection)(const ChessRuleSet &rules, const char *ChessBoard, int x, int y, int z, char player) { nullptr };
+};
+
+bool GetChessRuleSet(int BoardSize, int WinLength, ChessRuleSet *pRules);
+// CheckWinֻͬɹ
+int CheckWinRules(const ChessRuleSet &rules, const char *ChessBoard, int input[], char player);
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "chess-game.h"
+
+// ϡֻ̣ӵĸӣѰַϣ̽⣩ڴ޹
+// λ2ݡز1/2ÿռ18~36ֽڣÿ1ֽڣʵԼ3%~5%ʱŸʡڴ棻
+// ÿβѯȳ3~7c3-benchdense/sparseԱȣֻ200^3ռù
+// һͬʱй̶ܺܶԾʱѡãͨߴó/λ
+// Ƕһ麯UpdateBoardState/CheckWinһһӦͬû̹õĽӿڣ
+// ClientCheckMovesBatchĿǰл
+struct ChessSparseBoard
+{
+	int boardSize{ 0 };
+	uint64_t stones{ 0 };
+	std::vector<uint64_t> keys;    // 0ΪղۣΪ+1place()һ£64λ
+	std::vector<char> values;      // '1''2'
+};
+
+int64_t SparseBoardIndex(const ChessSparseBoard &board, int x, int y, int z);
+bool OnlineInitSparseBoard(ChessSparseBoard *pBoard, int BoardSize);
+void FreeSparseBoard(ChessSparseBoard *pBoard);
+char SparseBoardAt(const ChessSparseBoard &board, int x, int y, int z);
+bool UpdateSparseBoardState(ChessSparseBoard &board, int input[], char player);
+int CheckWinSparseBoard(const ChessSparseBoard &board, int input[], char player);
+
+// ӡļӿڣڷţChessDirections巵-1
+int SparseBoardWinDirection(const ChessSparseBoard &board, int x, int y, int z, char player);
+// ǰռõĶڴ棨ֽڣ
+size_t SparseBoardBytes(const ChessSparseBoard &board);
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// 48Գƣת뾵񣩣6û  3Ƿת
+// symԳƣperm = sym / 8ת = sym % 8sym = 0Ϊȱ任
+// 任i = ԭ[ChessSymmetryAxes[perm][i]]תiλΪ1ȡ BoardSize-1-ֵ
+const int ChessSymmetryCount = 48;
+
+// 任
+int SymmetryInverse(int sym);
+// ţplace()һ£Գsym
+int SymmetryMapCell(int cell, int sym, int BoardSize);
+// ꣨1ʼNativeGetChessPositionԼԳsym
+void SymmetryMapMove(const int input[3], int sym, int BoardSize, int output[3]);
+
+// ӳtable[sym*N^3 + cell]ΪԳƺĸţߴ绺棬̰߳ȫChessLineTableMaxSizenullptr
+const int32_t *GetChessSymmetryTable(int BoardSize);
+
+// 淶ϣ48ԳƾZobristϣеСֵpSymǿʱȡСֵĶԳ
+// ȼ۾Ĺ淶ϣͬԹ淶mԭжӦΪSymmetryMapCell(m, SymmetryInverse(sym), N)
+uint64_t ChessCanonicalHash(const char *ChessBoard, int BoardSize, int *pSym = nullptr);
+// ̱任淶ChessCanonicalHashѡĶԳһ£outputBoardSize^3ֽ
+void CanonicalizeBoard(const char *ChessBoard, int BoardSize, char *output, int *pSym = nullptr);
+
+// 48ԳƾZobristϣ/άÿ48
+// hashes[0]ͨZobristϣ
+struct ChessSymmetricHash
+{
+	uint64_t hashes[ChessSymmetryCount] {};
+};
+
+// 볷ͬ򣩣tableGetChessSymmetryTablekeysGetChessZobristKeys
+inline void SymmetricHashToggle(ChessSymmetricHash &hash, const int32_t *table, int cells, const uint64_t *keys,
+                                int cell, int plane)
+{
+	for (int s = 0; s < ChessSymmetryCount; s++)
+		hash.hashes[s] ^= keys[(size_t)table[(size_t)s * cells + cell] * 2 + plane];
+}
+
+uint64_t SymmetricHashCanonical(const ChessSymmetricHash &hash, int *pSym = nullptr);
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// вռĽ
+enum class ChessThreatStatus
+{
+	Win,        // ҵʤģ
+	NoWin,      // ȫģУûбʤ
+	Unknown     // ڵԤľδܵó
+};
+
+struct ChessThreatLimits
+{
+	uint64_t maxNodes{ 100000 };   // ڵԤ
+	int maxDepth{ 24 };            // ߼в
+	bool useThrees{ false };       // falseֻѳģVCFtrueVCTطɷģ
+};
+
+struct ChessThreatResult
+{
+	ChessThreatStatus status{ ChessThreatStatus::Unknown };
+	int move[3] { 0, 0, 0 };       // ʤʱĵһ֣(x, y, z)1ʼ
+	std::vector<int> sequence;     // ʤʱһ䣨˫棬place()һ£һֳ壩
+	uint64_t nodes{ 0 };
+	uint64_t elapsedUs{ 0 };
+};
+
+// ֻǿŷ13ϵĳġ֤attackerıʤ
+// ChessBoardΪOnlineInitChessBoarḍֵᱻ޸ģ̳ChessLineTableMaxSizeʱfalse
+bool SolveThreatSpace(const char *ChessBoard, int BoardSize, char attacker, const ChessThreatLimits &limits,
+                      ChessThreatResult &result);
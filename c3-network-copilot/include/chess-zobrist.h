@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstdint>
+#include "chess-bitboard.h"
+
+// Zobristÿ̴Сһףkeys[cell*2+plane]cellplace()һ
+// ɹ̶Ƶ̡ͬͬõĹϣ̵ֵͬݣ
+const uint64_t *GetChessZobristKeys(int BoardSize);
+
+uint64_t ChessZobristHash(const char *ChessBoard, int BoardSize);
+uint64_t ChessZobristHashBitBoard(const ChessBitBoard &board);
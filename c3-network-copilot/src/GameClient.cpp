@@ -1,5 +1,7 @@
 #include "../include/GameClient.h"
 #include "../include/chess-game.h"
+#include "../include/chess-bitboard.h"
+#include "../include/chess-log.h"
 #include <iostream>
 
 // 캯עصĳʱ߳
@@ -82,14 +84,16 @@ std::vector<lanp2p::PeerInfo> Client::getAvailablePeers()
 
 bool Client::requestMatch(const lanp2p::PeerInfo &peer)
 {
-	// ֹѴڶԾʱٴηƥ
+	// ֹѴڶԾʱٴηƥ䣻̨
+	bool inMatch;
 	{
 		std::lock_guard<std::mutex> lk(_matchMutex);
-		if (_match.inMatch)
-		{
-			std::cout << "ѾڶԾ" << std::endl;
-			return false;
-		}
+		inMatch = _match.inMatch;
+	}
+	if (inMatch)
+	{
+		std::cout << "ѾڶԾ" << std::endl;
+		return false;
 	}
 
 	// ƥID
@@ -132,6 +136,7 @@ void Client::handlePendingRequests()
 			std::cout << "ûд" << std::endl;
 			break;
 		}
+		ChessLogFlush();
 		std::cout << "\n====== ƥ ======\n";
 		std::cout << "from: "
 		          << (pr.peer.name.empty() ? pr.peer.id : pr.peer.name)
@@ -148,13 +153,15 @@ void Client::handlePendingRequests()
 		if (accept)
 		{
 			//ܺԾֲ״̬ҷɫΪ"Ӧ"
-			std::lock_guard<std::mutex> lk(_matchMutex);
-			_match.inMatch = true;
-			_match.peer = pr.peer;
-			_match.matchId = pr.matchId;
-			_iAmMatchInitiator = false;
-			//ע
-			_node.markMatchActive(pr.ip, pr.port, pr.peer.id, pr.matchId);
+			{
+				std::lock_guard<std::mutex> lk(_matchMutex);
+				_match.inMatch = true;
+				_match.peer = pr.peer;
+				_match.matchId = pr.matchId;
+				_iAmMatchInitiator = false;
+				//ע
+				_node.markMatchActive(pr.ip, pr.port, pr.peer.id, pr.matchId);
+			}
 			std::cout << "Էͬ⣬Ϸʼ" << std::endl;
 		}
 		else
@@ -178,20 +185,21 @@ void Client::startGame()
 			return;
 	}
 
-	std::cout << "\n\n=====Ϸʼ=====\n";
+	CHESS_LOG_INFO("\n\n=====Ϸʼ=====");
 
 	lanp2p::PeerInfo opponent;
 	{
 		std::lock_guard<std::mutex> lk(_matchMutex);
 		opponent = _match.peer;
 	}
-	std::cout << "Ķ֣" << (opponent.name.empty() ? opponent.id : opponent.name) << std::endl;
+	CHESS_LOG_INFO("Ķ֣%s", (opponent.name.empty() ? opponent.id : opponent.name).c_str());
 
 	initGameState();
 	gameLoop();
+	saveGameRecord();
 	cleanupGameState();
 
-	std::cout << "=====Ϸ=====\n\n";
+	CHESS_LOG_INFO("=====Ϸ=====\n");
 
 	std::lock_guard<std::mutex> lk(_matchMutex);
 	_match = MatchState{}; // öԾ״̬
@@ -217,11 +225,11 @@ void Client::endMatch()
 
 	if (wasInMatch)
 	{
-		std::cout << "[Client] INTϢ" << peer.ip << ":" << peer.tcpPort
-		          << ", matchId=" << matchId << std::endl;
+		CHESS_LOG_INFO("[Client] INTϢ%s:%u, matchId=%s", peer.ip.c_str(), (unsigned)peer.tcpPort, matchId.c_str());
 		_node.interruptMatch(peer.ip, peer.tcpPort, matchId);
 		_gameRunning = false; // ȷϷѭ˳
-		std::cout << "Ϸϣ" << std::endl;
+		_moveCv.notify_all();
+		CHESS_LOG_INFO("Ϸϣ");
 	}
 }
 
@@ -242,8 +250,8 @@ lanp2p::PeerInfo Client::getMatchPeer() const
 
 void Client::onPeerDiscovered(const lanp2p::PeerInfo &p)
 {
-	std::cout << "[Client DBG] Peer discovered: name=" << (p.name.empty() ? "<noname>" : p.name)
-	          << " id=" << p.id << " at " << p.ip << ":" << p.tcpPort << std::endl;
+	CHESS_LOG_DEBUG("[Client DBG] Peer discovered: name=%s id=%s at %s:%u", p.name.empty() ? "<noname>" : p.name.c_str(),
+	                p.id.c_str(), p.ip.c_str(), (unsigned)p.tcpPort);
 }
 
 void Client::onMatchRequest(const lanp2p::PeerInfo &p, const std::string &matchId)
@@ -260,17 +268,13 @@ void Client::onMatchRequest(const lanp2p::PeerInfo &p, const std::string &matchI
 		std::lock_guard<std::mutex> lk(_pendingMutex);
 		_pendingQueue.push_back(std::move(pr));
 	}
-	std::cout << "\n[]ԣ"
-	          << (p.name.empty() ? p.id : p.name)
-	          << ".ѡѡ" << std::endl;
+	CHESS_LOG_INFO("\n[]ԣ%s.ѡѡ", (p.name.empty() ? p.id : p.name).c_str());
 }
 
 void Client::onMatchResponse(const lanp2p::PeerInfo &p, bool accepted, const std::string &matchId)
 {
-	std::cout << "[ظ]ԣ"
-	          << (p.name.empty() ? p.id : p.name)
-	          << " match=" << matchId
-	          << " accepted=" << (accepted ? "true" : "false") << std::endl;
+	CHESS_LOG_INFO("[ظ]ԣ%s match=%s accepted=%s", (p.name.empty() ? p.id : p.name).c_str(), matchId.c_str(),
+	               accepted ? "true" : "false");
 	if (accepted)
 	{
 		//ҷΪʱԷܺضԾ״̬ǡߡ
@@ -284,15 +288,14 @@ void Client::onMatchResponse(const lanp2p::PeerInfo &p, bool accepted, const std
 
 void Client::onMatchInterrupted(const lanp2p::PeerInfo &p, const std::string &matchId)
 {
-	std::cout << "[] ԣ"
-	          << (p.name.empty() ? p.id : p.name)
-	          << " match=" << matchId << std::endl;
+	CHESS_LOG_INFO("[] ԣ%s match=%s", (p.name.empty() ? p.id : p.name).c_str(), matchId.c_str());
 
 	std::lock_guard<std::mutex> lk(_matchMutex);
 	if (_match.inMatch && _match.matchId == matchId && _match.peer.id == p.id)
 	{
 		_match = MatchState{};
 		_gameRunning = false; // ֹͣϷѭ
+		_moveCv.notify_all();
 	}
 }
 
@@ -311,11 +314,14 @@ void Client::onGameMove(const lanp2p::PeerInfo &p, int x, int y, int z)
 		if (x < 1 || x > _boardSize || y < 1 || y > _boardSize || z < 1 || z > _boardSize)
 			return;
 
-		std::lock_guard<std::mutex> lk(_moveMutex);
-		_opponentMove[0] = x;
-		_opponentMove[1] = y;
-		_opponentMove[2] = z;
-		_opponentMoved = true;
+		{
+			std::lock_guard<std::mutex> lk(_moveMutex);
+			_opponentMove[0] = x;
+			_opponentMove[1] = y;
+			_opponentMove[2] = z;
+			_opponentMoved = true;
+		}
+		_moveCv.notify_one();
 	}
 }
 
@@ -342,8 +348,8 @@ void Client::timeoutThreadLoop()
 		if (expired && pr.has)
 		{
 			_node.respondToMatch(pr.ip, pr.port, pr.matchId, false);
-			std::cout << "[Auto] Rejected (timeout) match " << pr.matchId << " for peer "
-			          << (pr.peer.name.empty() ? pr.peer.id : pr.peer.name) << std::endl;
+			CHESS_LOG_INFO("[Auto] Rejected (timeout) match %s for peer %s", pr.matchId.c_str(),
+			               (pr.peer.name.empty() ? pr.peer.id : pr.peer.name).c_str());
 		}
 		std::this_thread::sleep_for(std::chrono::milliseconds(200));
 	}
@@ -368,9 +374,9 @@ void Client::initGameState()
 {
 	// ʼ̣ȷͷţ
 	cleanupGameState();
-	if (!OnlineInitChessBoard(&_chessBoard, _boardSize))
+	if (!OnlineInitBitBoard(&_chessBoard, _boardSize))
 	{
-		std::cout << "FATAL:޷ʼ" << std::endl;
+		CHESS_LOG_ERROR("FATAL:޷ʼ");
 		endMatch();
 		return;
 	}
@@ -400,41 +406,167 @@ void Client::initGameState()
 	_myPlayer = iAmFirstPlayer ? '1' : '2';
 	_myTurn = (_myPlayer == '1');
 	_gameRunning = true;
-	_opponentMoved = false;
+	{
+		std::lock_guard<std::mutex> lk(_moveMutex);
+		_opponentMoved = false;
+	}
 
-	std::cout << "̳ʼɣ" << _myPlayer
-	          << " (" << (_iAmMatchInitiator ? "" : "Ӧ")
-	          << ", matchId: " << matchId.substr(0, 4) << "...)." << std::endl;
+	// ѡֵԴ
+	{
+		std::lock_guard<std::mutex> lk(_providerMutex);
+		_matchMoves = _customMoves;
+	}
+	if (_matchMoves)
+		_moves = _matchMoves.get();
+	else if (_engineEnabled.load())
+		_moves = &_engineMoves;
+	else
+		_moves = &_consoleMoves;
+	_moves->onGameStart(_boardSize, _myPlayer);
+
+	// Ծּ¼peerIds[0]Ϊ
+	lanp2p::PeerInfo opponent;
+	{
+		std::lock_guard<std::mutex> lk(_matchMutex);
+		opponent = _match.peer;
+	}
+	uint64_t myId = ChessRecordParseId(_node.getNodeId()), opponentId = ChessRecordParseId(opponent.id);
+	_recordHeader = ChessRecordHeader{};
+	_recordHeader.matchId = ChessRecordParseId(matchId);
+	_recordHeader.peerIds[0] = _iAmMatchInitiator ? myId : opponentId;
+	_recordHeader.peerIds[1] = _iAmMatchInitiator ? opponentId : myId;
+	_recordHeader.startUnixMs = (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+	                                std::chrono::system_clock::now().time_since_epoch()).count();
+	_recordHeader.boardSize = (uint8_t)_boardSize;
+	_recordHeader.firstPeer = (iAmFirstPlayer == _iAmMatchInitiator) ? 0 : 1;
+	_recordHeader.result = ChessRecordUnfinished;
+	_recordMoves.clear();
+	_gameStart = std::chrono::steady_clock::now();
+
+	CHESS_LOG_INFO("̳ʼɣ%c (%s, matchId: %s...).", _myPlayer, _iAmMatchInitiator ? "" : "Ӧ",
+	               matchId.substr(0, 4).c_str());
 	if (_myTurn)
 	{
-		std::cout << "Ļغ" << std::endl;
+		CHESS_LOG_INFO("Ļغ");
 	}
 	else
 	{
-		std::cout << "ȴ" << std::endl;
+		CHESS_LOG_INFO("ȴ");
 	}
 }
 
 void Client::cleanupGameState()
 {
-	if (_chessBoard)
+	if (_moves)
+		_moves->onGameEnd();
+	_moves = nullptr;
+	_matchMoves.reset();
+	FreeBitBoard(&_chessBoard);
+}
+
+void Client::recordMove(const int coords[], char player)
+{
+	ChessRecordMove m;
+	m.x = (uint8_t)coords[0];
+	m.y = (uint8_t)coords[1];
+	m.z = (uint8_t)coords[2];
+	m.player = (uint8_t)player;
+	m.timeMs = (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - _gameStart).count();
+	_recordMoves.push_back(m);
+}
+
+void Client::saveGameRecord()
+{
+	if (_recordPath.empty() || _recordMoves.empty())
+		return;
+	_recordHeader.moveCount = (uint32_t)_recordMoves.size();
+	if (AppendChessRecord(_recordPath.c_str(), _recordHeader, _recordMoves.data()))
+		CHESS_LOG_INFO("[Client] ԾѼ¼%s%u", _recordPath.c_str(), (unsigned)_recordMoves.size());
+	_recordMoves.clear();
+}
+
+void Client::setEnginePonder(bool enabled)
+{
+	_engineMoves.setPonder(enabled);
+	std::cout << "[Client] AĮ˼" << (enabled ? "ѿ" : "ѹر") << std::endl;
+}
+
+bool Client::isEnginePondering() const
+{
+	return _engineMoves.pondering();
+}
+
+void Client::setBookPath(const std::string &path)
+{
+	_engineMoves.setBookPath(path);
+}
+
+void Client::setRecordPath(const std::string &path)
+{
+	_recordPath = path;
+}
+
+void Client::setMoveProvider(const std::shared_ptr<MoveProvider> &provider)
+{
 	{
-		free(_chessBoard);
-		_chessBoard = nullptr;
+		std::lock_guard<std::mutex> lk(_providerMutex);
+		_customMoves = provider;
 	}
+	std::cout << "[Client] Դ: " << (provider ? provider->name() : (_engineEnabled.load() ? "engine" : "console")) << std::endl;
+}
+
+void Client::setEngineEnabled(bool enabled)
+{
+	_engineEnabled = enabled;
+	std::cout << "[Client] AIй" << (enabled ? "ѿ" : "ѹر") << std::endl;
+}
+
+bool Client::isEngineEnabled() const
+{
+	return _engineEnabled.load();
+}
+
+void Client::setEngineTimeMs(int ms)
+{
+	_engineMoves.setTimeMs(ms);
+}
+
+void Client::setEngineThreads(int threads)
+{
+	_engineMoves.setThreads(threads);
+}
+
+void Client::setEngineUseMcts(bool useMcts)
+{
+	_engineMoves.setUseMcts(useMcts);
+	std::cout << "[Client] AI㷨: " << (useMcts ? "MCTS" : "alpha-beta") << std::endl;
+}
+
+bool Client::isEngineUsingMcts() const
+{
+	return _engineMoves.usingMcts();
 }
 
 void Client::gameLoop()
 {
-	// ѭݻغϾӻ
+	// ѭغԴҪһԷغϵȴص
+	const char opponentPlayer = (_myPlayer == '1') ? '2' : '1';
 	while (_gameRunning.load())
 	{
 		if (_myTurn)
 		{
 			int coords[3];
-			NativeGetChessPosition(coords);
-			if (UpdateBoardState(_boardSize, _chessBoard, coords, _myPlayer))
+			if (!_moves->getMove(_chessBoard, _myPlayer, coords))
+			{
+				CHESS_LOG_WARN("[Client] Դ(%s)ûиӣԾ", _moves->name());
+				endMatch();
+				break;
+			}
+			if (!_gameRunning.load())
+				break; // ˼ڼԾѱ
+			if (UpdateBitBoardState(_chessBoard, coords, _myPlayer))
 			{
+				recordMove(coords, _myPlayer);
 				// ȡϢҷӸ
 				lanp2p::PeerInfo opponent;
 				{
@@ -443,44 +575,51 @@ void Client::gameLoop()
 				}
 
 				_node.sendGameMove(opponent.ip, opponent.tcpPort, coords[0], coords[1], coords[2]);
-				if (CheckWin(_boardSize, _chessBoard, coords, _myPlayer))
+				if (CheckWinBitBoard(_chessBoard, coords, _myPlayer))
 				{
-					std::cout << "Ӯ" << std::endl;
+					_recordHeader.result = (_myPlayer == '1') ? ChessRecordPlayer1Wins : ChessRecordPlayer2Wins;
+					CHESS_LOG_INFO("Ӯ");
 					_gameRunning = false;
 					break;
 				}
 				_myTurn = false;
-				std::cout << "ȴ" << std::endl;
+				CHESS_LOG_INFO("ȴ");
+				_moves->onMove(_chessBoard, coords, _myPlayer);
 			}
 			else
 			{
-				std::cout << "Ч" << std::endl;
+				CHESS_LOG_INFO("Ч");
 			}
 		}
 		else // ֵ
 		{
-			bool moved = false;
+			int move[3];
 			{
-				std::lock_guard<std::mutex> lk(_moveMutex);
-				if (_opponentMoved)
+				// ӵＴѣʱֻڶ׼ԾǷѽ
+				std::unique_lock<std::mutex> lk(_moveMutex);
+				_moveCv.wait_for(lk, std::chrono::milliseconds(100), [this]
 				{
-					char opponentPlayer = (_myPlayer == '1') ? '2' : '1';
-					UpdateBoardState(_boardSize, _chessBoard, _opponentMove, opponentPlayer);
-					if (CheckWin(_boardSize, _chessBoard, _opponentMove, opponentPlayer))
-					{
-						std::cout << "" << std::endl;
-						_gameRunning = false;
-					}
-					_opponentMoved = false;
-					moved = true;
-				}
+					return _opponentMoved || !_gameRunning.load();
+				});
+				if (!_opponentMoved)
+					continue;
+				move[0] = _opponentMove[0];
+				move[1] = _opponentMove[1];
+				move[2] = _opponentMove[2];
+				_opponentMoved = false;
 			}
-			if (moved)
+			if (UpdateBitBoardState(_chessBoard, move, opponentPlayer))
+				recordMove(move, opponentPlayer);
+			_myTurn = true;
+			if (CheckWinBitBoard(_chessBoard, move, opponentPlayer))
 			{
-				_myTurn = true;
-				std::cout << "Ļغ" << std::endl;
+				_recordHeader.result = (opponentPlayer == '1') ? ChessRecordPlayer1Wins : ChessRecordPlayer2Wins;
+				CHESS_LOG_INFO("");
+				_gameRunning = false;
+				break;
 			}
+			_moves->onMove(_chessBoard, move, opponentPlayer);
+			CHESS_LOG_INFO("Ļغ");
 		}
-		std::this_thread::sleep_for(std::chrono::milliseconds(100));
 	}
 }
@@ -1,4 +1,5 @@
 #include "../include/LanP2PNode.h"
+#include "../include/chess-log.h"
 
 #define _WINSOCK_DEPRECATED_NO_WARNINGS
 #include <winsock2.h>
@@ -9,6 +10,7 @@
 #include <random>
 #include <sstream>
 #include <cstdio>
+#include <cstring>
 #include <tuple>
 
 namespace lanp2p
@@ -29,6 +31,194 @@ namespace lanp2p
 		return setsockopt(static_cast<SOCKET>(s), SOL_SOCKET, SO_REUSEADDR, (const char *)&yes, sizeof(yes)) == 0;
 	}
 
+	// Ч׽־INVALID_SOCKETͬλģʽ
+	static const uintptr_t INVALID_SOCK = ~(uintptr_t)0;
+	// ֡ȣֹ˷ͳ֡
+	static const uint32_t MAX_FRAME_SIZE = 8192;
+	// ͻʱȴʱ䣨Direct¼ѭʣಿ֣¼ѭδʱȿд
+	static const int SEND_WAIT_MS = 2000;
+	// BatchedӻѹĴֽޣΪԶ˲ٶȡ
+	static const size_t MAX_QUEUED_BYTES = 256 * 1024;
+	// ¼ѭջСÿξȡĴӣ
+	static const size_t READ_BUF_SIZE = 64 * 1024;
+	static const int MAX_READS_PER_EVENT = 8;
+
+	// Э飺֡WIRE_MAGICͷıЭASCIIĸͷ֮ǰ汾Ϣͣ
+	// ٽӸ͵ĶֶΣһСˣڵIDƥIDΪ16λʮַӦ64λ
+	static const uint8_t WIRE_MAGIC = 0xC3;
+	static const uint8_t WIRE_VERSION = 1;
+	static const size_t WIRE_HEADER_SIZE = 4; // magic version type 
+	enum WireType : uint8_t
+	{
+		WIRE_REQ = 1,   // fromId u64, matchId u64, toId u640ʾδָ, fromPort u16
+		WIRE_RESP = 2,  // fromId u64, matchId u64, accepted u8
+		WIRE_INT = 3,   // fromId u64, matchId u64
+		WIRE_HB = 4,    // fromId u64, matchId u64
+		WIRE_MOVE = 5   // x i16, y i16, z i16, 2ֽڣͬǰ׺16ֽڣ
+	};
+
+	static void putU16(std::string &out, uint16_t v)
+	{
+		out.push_back((char)(v & 0xFF));
+		out.push_back((char)(v >> 8));
+	}
+
+	static void putU64(std::string &out, uint64_t v)
+	{
+		for (int i = 0; i < 8; ++i)
+			out.push_back((char)((v >> (8 * i)) & 0xFF));
+	}
+
+	static uint16_t getU16(const char *p)
+	{
+		return (uint16_t)((uint8_t)p[0] | (uint16_t)(uint8_t)p[1] << 8);
+	}
+
+	static uint64_t getU64(const char *p)
+	{
+		uint64_t v = 0;
+		for (int i = 7; i >= 0; --i)
+			v = v << 8 | (uint8_t)p[i];
+		return v;
+	}
+
+	static std::string wireHeader(uint8_t type, size_t bodySize)
+	{
+		std::string out;
+		out.reserve(WIRE_HEADER_SIZE + bodySize);
+		out.push_back((char)WIRE_MAGIC);
+		out.push_back((char)WIRE_VERSION);
+		out.push_back((char)type);
+		out.push_back(0);
+		return out;
+	}
+
+	// IDֻrandomIdɵĹ淶ʽ16λСдʮƣʱתIDֻıЭ
+	static bool parseWireId(const std::string &id, uint64_t &v)
+	{
+		if (id.size() != 16)
+			return false;
+		v = 0;
+		for (char ch : id)
+		{
+			int d;
+			if (ch >= '0' && ch <= '9')
+				d = ch - '0';
+			else if (ch >= 'a' && ch <= 'f')
+				d = ch - 'a' + 10;
+			else
+				return false;
+			v = v << 4 | (uint64_t)d;
+		}
+		return true;
+	}
+
+	// 64λIDд16λСдʮƣrandomIdĸʽһ£β'\0'
+	static void writeWireId(uint64_t v, char out[16])
+	{
+		static const char digits[] = "0123456789abcdef";
+		for (int i = 15; i >= 0; --i)
+		{
+			out[i] = digits[v & 15];
+			v >>= 4;
+		}
+	}
+
+	// ʮstd::stoiһ£ǰհţֹּͣûֻ򳬳intΧʱfalse
+	static bool parseInt(const char *p, size_t n, int &v)
+	{
+		const char *end = p + n;
+		while (p < end && (*p == ' ' || *p == '\t'))
+			++p;
+		bool neg = false;
+		if (p < end && (*p == '+' || *p == '-'))
+		{
+			neg = *p == '-';
+			++p;
+		}
+		if (p == end || *p < '0' || *p > '9')
+			return false;
+		long long acc = 0;
+		while (p < end && *p >= '0' && *p <= '9')
+		{
+			acc = acc * 10 + (*p - '0');
+			if (acc > 2147483648LL)
+				return false;
+			++p;
+		}
+		if (neg)
+			acc = -acc;
+		if (acc > 2147483647LL)
+			return false;
+		v = (int)acc;
+		return true;
+	}
+
+	// ʮ׷ӵoutoutstd::to_string
+	static void appendUInt(std::string &out, unsigned v)
+	{
+		char buf[10];
+		int n = 0;
+		do
+		{
+			buf[n++] = (char)('0' + v % 10);
+			v /= 10;
+		}
+		while (v != 0);
+		while (n > 0)
+			out.push_back(buf[--n]);
+	}
+
+	// fromId+matchIdͷĶϢREQ/RESP/INT/HBIDǹ淶ʽʱؿմ
+	static std::string wireIdMessage(uint8_t type, size_t bodySize, const std::string &fromId, const std::string &matchId)
+	{
+		uint64_t from, match;
+		if (!parseWireId(fromId, from) || !parseWireId(matchId, match))
+			return std::string();
+		std::string out = wireHeader(type, bodySize);
+		putU64(out, from);
+		putU64(out, match);
+		return out;
+	}
+
+	// ׷һ֡4ֽ򳤶 + 
+	static void appendFrame(std::string &out, const std::string &payload)
+	{
+		uint32_t be = htonl((uint32_t)payload.size());
+		out.append((const char *)&be, 4);
+		out.append(payload);
+	}
+
+	// Ͷǰlimitֽ֡ռֽڣܴ߽֡翪ʼ
+	static size_t completeFrames(const std::string &buf, size_t limit)
+	{
+		size_t pos = 0;
+		while (pos + 4 <= limit)
+		{
+			uint32_t be;
+			std::memcpy(&be, buf.data() + pos, 4);
+			const size_t next = pos + 4 + ntohl(be);
+			if (next > limit)
+				break;
+			pos = next;
+		}
+		return pos;
+	}
+
+	// Ϊ¼ѭе׽֣
+	static bool setNonBlocking(uintptr_t s)
+	{
+		u_long yes = 1;
+		return ioctlsocket(static_cast<SOCKET>(s), FIONBIO, &yes) == 0;
+	}
+
+	// رNagleϢС֡ϲܵȴϲ
+	static void setNoDelay(uintptr_t s)
+	{
+		BOOL yes = TRUE;
+		setsockopt(static_cast<SOCKET>(s), IPPROTO_TCP, TCP_NODELAY, (const char *)&yes, sizeof(yes));
+	}
+
 	// UDP㲥
 	static bool setBroadcast(uintptr_t s)
 	{
@@ -64,7 +254,7 @@ namespace lanp2p
 		}
 		_udpBroadcaster = std::thread(&LanP2PNode::udpBroadcastLoop, this);
 		_udpListener = std::thread(&LanP2PNode::udpListenLoop, this);
-		_tcpListener = std::thread(&LanP2PNode::tcpListenLoop, this);
+		_tcpListener = std::thread(&LanP2PNode::tcpEventLoop, this);
 	}
 
 	// 㲥TCP
@@ -82,7 +272,7 @@ namespace lanp2p
 		if (!_tcpActive.exchange(true)
 		    && !_tcpListener.joinable())
 		{
-			_tcpListener = std::thread(&LanP2PNode::tcpListenLoop, this);
+			_tcpListener = std::thread(&LanP2PNode::tcpEventLoop, this);
 		}
 		if (!_maintenanceActive.exchange(true)
 		    && !_maintenanceThread.joinable())
@@ -148,6 +338,7 @@ namespace lanp2p
 			sendto(static_cast<SOCKET>(ps), "", 0, 0, (sockaddr *)&a, sizeof(a));
 			closesock(ps);
 		}
+		wakeReactor();
 		if (_udpBroadcaster.joinable())
 			_udpBroadcaster.join();
 		if (_udpListener.joinable())
@@ -156,6 +347,8 @@ namespace lanp2p
 			_tcpListener.join();
 		if (_maintenanceThread.joinable())
 			_maintenanceThread.join();
+		std::lock_guard<std::mutex> lk(_connMutex);
+		_retryFrames.clear();
 	}
 
 	// ûص
@@ -196,9 +389,9 @@ namespace lanp2p
 			if (_peerStaleMs > 0 && (now - it->second.lastSeenMs) > _peerStaleMs)
 			{
 				const PeerInfo &p = it->second;
-				std::printf("[LanP2PNode][DEBUG] ʱƳ peer (DISC ): id=%s ip=%s port=%u lastSeenMs=%llu nowMs=%llu staleMs=%llu\n",
-				            p.id.c_str(), p.ip.c_str(), (unsigned)p.tcpPort,
-				            (unsigned long long)p.lastSeenMs, (unsigned long long)now, (unsigned long long)_peerStaleMs);
+				CHESS_LOG_DEBUG("[LanP2PNode][DEBUG] ʱƳ peer (DISC ): id=%s ip=%s port=%u lastSeenMs=%llu nowMs=%llu staleMs=%llu",
+				                p.id.c_str(), p.ip.c_str(), (unsigned)p.tcpPort,
+				                (unsigned long long)p.lastSeenMs, (unsigned long long)now, (unsigned long long)_peerStaleMs);
 				it = _peersByKey.erase(it);
 			}
 			else
@@ -354,37 +547,26 @@ namespace lanp2p
 		closesock(s);
 	}
 
-	// ӣԣ
+	// 
 	bool LanP2PNode::sendGameMove(const std::string &peerIp, uint16_t peerTcpPort, int x, int y, int z)
 	{
-		for (int attempt = 0; attempt < _maxSendRetries; ++attempt)
+		std::ostringstream oss;
+		oss << "MOVE|" << x << "|" << y << "|" << z << "|";
+		std::string bin;
+		if (x >= INT16_MIN && x <= INT16_MAX && y >= INT16_MIN && y <= INT16_MAX && z >= INT16_MIN && z <= INT16_MAX)
 		{
-			uintptr_t s = (uintptr_t)socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-			if ((SOCKET)s == INVALID_SOCKET)
-				return false;
-			sockaddr_in addr{};
-			addr.sin_family = AF_INET;
-			addr.sin_port = htons(peerTcpPort);
-			addr.sin_addr.s_addr = inet_addr(peerIp.c_str());
-			if (connect(static_cast<SOCKET>(s), (sockaddr * )&addr, sizeof(addr)) != 0)
-			{
-				closesock(s);
-				std::this_thread::sleep_for(std::chrono::milliseconds(50));
-				continue;
-			}
-			std::ostringstream oss;
-			oss << "MOVE|" << x << "|" << y << "|" << z << "|";
-			bool ok = tcpSendFramed(s, oss.str());
-			closesock(s);
-			if (ok)
-				return true;
-			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			bin = wireHeader(WIRE_MOVE, 8);
+			putU16(bin, (uint16_t)(int16_t)x);
+			putU16(bin, (uint16_t)(int16_t)y);
+			putU16(bin, (uint16_t)(int16_t)z);
+			putU16(bin, 0);
 		}
-		return false;
+		return sendToPeer(peerIp, peerTcpPort, oss.str(), bin);
 	}
 
-	// TCPѭӲַЭ飩
-	void LanP2PNode::tcpListenLoop()
+	// TCP¼ѭ׽ȫӾΪɱ߳WSAPollȴӡַ֡
+	// ̶߳
+	void LanP2PNode::tcpEventLoop()
 	{
 		uintptr_t s = (uintptr_t)socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
 		if ((SOCKET)s == INVALID_SOCKET)
@@ -431,400 +613,1051 @@ namespace lanp2p
 		_tcpPort = chosen;
 		_tcpBoundReady.store(true);
 
-		if (listen(static_cast<SOCKET>(s), 8) != 0)
+		if (listen(static_cast<SOCKET>(s), SOMAXCONN) != 0)
 		{
 			closesock(s);
 			return;
 		}
+		setNonBlocking(s);
+
+		// õUDP׽̵֣߳Ǽӻstopʱһֽ
+		uintptr_t w = (uintptr_t)socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+		if ((SOCKET)w == INVALID_SOCKET)
+		{
+			closesock(s);
+			return;
+		}
+		sockaddr_in wa{};
+		wa.sin_family = AF_INET;
+		wa.sin_port = htons(0);
+		wa.sin_addr.s_addr = inet_addr("127.0.0.1");
+		int wl = sizeof(wa);
+		if (bind(static_cast<SOCKET>(w), (sockaddr *)&wa, sizeof(wa)) != 0
+		    || getsockname(static_cast<SOCKET>(w), (sockaddr *)&wa, &wl) != 0)
+		{
+			closesock(w);
+			closesock(s);
+			return;
+		}
+		setNonBlocking(w);
+		_readBuf.resize(READ_BUF_SIZE);
+		{
+			std::lock_guard<std::mutex> lk(_connMutex);
+			_wakeSock = w;
+			_wakePort = ntohs(wa.sin_port);
+			_flushConns.clear();
+			_reactorReady = true;
+		}
+
+		std::vector<std::shared_ptr<Connection>> conns;
+		std::vector<std::shared_ptr<Connection>> flush;
+		std::vector<WSAPOLLFD> fds;
 		while (_running && _tcpActive)
 		{
-			sockaddr_in cli{};
-			int cl = sizeof(cli);
-			uintptr_t c = (uintptr_t)accept(static_cast<SOCKET>(s), (sockaddr *)&cli, &cl);
-			if ((SOCKET)c == INVALID_SOCKET)
 			{
-				std::this_thread::sleep_for(std::chrono::milliseconds(50));
+				std::lock_guard<std::mutex> lk(_connMutex);
+				conns.insert(conns.end(), _pendingConns.begin(), _pendingConns.end());
+				_pendingConns.clear();
+				flush.swap(_flushConns);
+			}
+			// BatchedһŶӵ֡һsend
+			for (auto& c : flush)
+			{
+				if (!flushConnection(c))
+					dropConnection(c);
+			}
+			flush.clear();
+			fds.resize(2 + conns.size());
+			fds[0].fd = static_cast<SOCKET>(s);
+			fds[1].fd = static_cast<SOCKET>(w);
+			for (size_t i = 0; i < conns.size(); ++i)
+				fds[2 + i].fd = static_cast<SOCKET>(conns[i]->sock);
+			for (size_t i = 0; i < fds.size(); ++i)
+			{
+				fds[i].events = POLLRDNORM;
+				if (i >= 2 && conns[i - 2]->wantWrite)
+					fds[i].events |= POLLWRNORM;
+				fds[i].revents = 0;
+			}
+			if (WSAPoll(fds.data(), (ULONG)fds.size(), 500) < 0)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(10));
 				continue;
 			}
-			std::string rip = inet_ntoa(cli.sin_addr);
-			std::thread(&LanP2PNode::tcpConnectionHandler, this, c, rip).detach();
+			if (fds[1].revents)
+			{
+				char b[64];
+				while (recv(static_cast<SOCKET>(w), b, sizeof(b), 0) > 0)
+				{
+				}
+			}
+			// ȴѵǼӵĶ¼½ܵһֲżѯ
+			const size_t polled = conns.size();
+			for (size_t i = 0; i < polled; ++i)
+			{
+				const std::shared_ptr<Connection> &c = conns[i];
+				if (!c->closed && (fds[2 + i].revents & (POLLRDNORM | POLLERR | POLLHUP | POLLNVAL)) && !tcpReadFrames(c))
+					dropConnection(c);
+				if (!c->closed && c->wantWrite && (fds[2 + i].revents & POLLWRNORM) && !flushConnection(c))
+					dropConnection(c);
+			}
+			if (fds[0].revents & POLLRDNORM)
+			{
+				while (true)
+				{
+					sockaddr_in cli{};
+					int cl = sizeof(cli);
+					uintptr_t c = (uintptr_t)accept(static_cast<SOCKET>(s), (sockaddr *)&cli, &cl);
+					if ((SOCKET)c == INVALID_SOCKET)
+						break;
+					setNoDelay(c);
+					setNonBlocking(c);
+					auto conn = std::make_shared<Connection>();
+					conn->sock = c;
+					conn->ip = inet_ntoa(cli.sin_addr);
+					conns.push_back(conn);
+				}
+			}
+			// رʧЧӣʧܣ򱻷ͷǣ
+			for (size_t i = 0; i < conns.size(); )
+			{
+				if (conns[i]->closed)
+				{
+					closeConnection(conns[i]);
+					conns[i] = conns.back();
+					conns.pop_back();
+				}
+				else
+				{
+					++i;
+				}
+			}
 		}
+
+		{
+			std::lock_guard<std::mutex> lk(_connMutex);
+			conns.insert(conns.end(), _pendingConns.begin(), _pendingConns.end());
+			_pendingConns.clear();
+			_wakePort = 0;
+			_wakeSock = INVALID_SOCK;
+			_reactorReady = false;
+			_flushConns.clear();
+		}
+		for (auto& c : conns)
+			closeConnection(c);
+		closesock(w);
 		closesock(s);
 	}
 
-	//  ip+id ҶԶTCP˿
-	uint16_t LanP2PNode::findPeerTcpPort(const std::string &ip, const std::string &id)
+	// ֡һֶΣָջеֽڣ
+	struct FieldRef
 	{
-		std::lock_guard<std::mutex> lk(_peersMutex);
-		for (auto& kv : _peersByKey)
+		const char *data;
+		size_t size;
+	};
+
+	static bool fieldEquals(const FieldRef &f, const std::string &s)
+	{
+		return f.size == s.size() && std::memcmp(f.data, s.data(), f.size) == 0;
+	}
+
+	// ıϢopcode֮Ĳְ'|'гֶΣÿֶ'|'βֶ
+	static size_t splitFields(const char *p, const char *end, FieldRef *out, size_t maxFields)
+	{
+		size_t n = 0;
+		while (n < maxFields && p < end)
+		{
+			const char *bar = (const char *)std::memchr(p, '|', (size_t)(end - p));
+			if (bar == nullptr)
+				break;
+			out[n].data = p;
+			out[n].size = (size_t)(bar - p);
+			++n;
+			p = bar + 1;
+		}
+		return n;
+	}
+
+	// ip:port:idԶ˱ƥļд븴õkey
+	static void buildPeerKey(std::string &key, const std::string &ip, uint16_t port, const FieldRef &id)
+	{
+		key.assign(ip);
+		key.push_back(':');
+		appendUInt(key, port);
+		key.push_back(':');
+		key.append(id.data, id.size);
+	}
+
+	// ַһ֡Э鲢صϲ㣩¼ѭ߳еã֡WIRE_MAGICͷఴıЭ
+	// ıϢopcodeгֶνӦĴֶָջ壬
+	void LanP2PNode::dispatchFrame(const std::shared_ptr<Connection> &conn, const char *data, size_t size)
+	{
+		if (size > 0 && (uint8_t)data[0] == WIRE_MAGIC)
+		{
+			dispatchBinary(conn, data, size);
+			return;
+		}
+		struct TextOpcode
+		{
+			const char *name;   // β'|'
+			size_t nameLen;
+			size_t minFields;
+			void (LanP2PNode::*handler)(const std::shared_ptr<Connection> &, const FieldRef *, size_t);
+		};
+		// ԾеĳƵ
+		static const TextOpcode opcodes[] =
+		{
+			{ "MOVE|", 5, 3, &LanP2PNode::onTextMove },
+			{ "HB|", 3, 2, &LanP2PNode::onTextHeartbeat },
+			{ "REQ|", 4, 3, &LanP2PNode::onTextRequest },
+			{ "RESP|", 5, 3, &LanP2PNode::onTextResponse },
+			{ "INT|", 4, 2, &LanP2PNode::onTextInterrupt },
+			{ "HELLO|", 6, 2, &LanP2PNode::onTextHello },
+		};
+		for (const TextOpcode &op : opcodes)
+		{
+			if (size < op.nameLen || std::memcmp(data, op.name, op.nameLen) != 0)
+				continue;
+			FieldRef fields[4];
+			size_t n = splitFields(data + op.nameLen, data + size, fields, 4);
+			if (n >= op.minFields)
+				(this->*op.handler)(conn, fields, n);
+			return;
+		}
+	}
+
+	// ַһ֡ϢͲֱֶӰƫƶȡȲ汾ʶ֡
+	void LanP2PNode::dispatchBinary(const std::shared_ptr<Connection> &conn, const char *data, size_t size)
+	{
+		if (size < WIRE_HEADER_SIZE)
+			return;
+		const uint8_t version = (uint8_t)data[1];
+		const uint8_t type = (uint8_t)data[2];
+		if (version == 0 || version > WIRE_VERSION)
+		{
+			CHESS_LOG_DEBUG("[LanP2PNode][DEBUG] Բֵ֧ĶЭ汾%u%s", (unsigned)version, conn->ip.c_str());
+			return;
+		}
+		struct BinaryOpcode
+		{
+			size_t bodySize;
+			void (LanP2PNode::*handler)(const std::shared_ptr<Connection> &, const char *);
+		};
+		// ±꼴WireType
+		static const BinaryOpcode opcodes[] =
+		{
+			{ 0, nullptr },
+			{ 26, &LanP2PNode::onBinaryRequest },
+			{ 17, &LanP2PNode::onBinaryResponse },
+			{ 16, &LanP2PNode::onBinaryInterrupt },
+			{ 16, &LanP2PNode::onBinaryHeartbeat },
+			{ 8, &LanP2PNode::onBinaryMove },
+		};
+		if (type >= sizeof(opcodes) / sizeof(opcodes[0]) || opcodes[type].handler == nullptr
+		        || size - WIRE_HEADER_SIZE != opcodes[type].bodySize)
+			return;
+		(this->*opcodes[type].handler)(conn, data + WIRE_HEADER_SIZE);
+	}
+
+	// HELLO|fromId|fromPort|[BINn|]Զ˽ĳӣǼǺҲ
+	// BINnʾԶշnЭ飻ҷյHELLOǶԶ˶Э̵Ӧ
+	void LanP2PNode::onTextHello(const std::shared_ptr<Connection> &conn, const FieldRef *f, size_t n)
+	{
+		int peerVersion = 0;
+		if (n >= 3 && f[2].size > 3 && std::memcmp(f[2].data, "BIN", 3) == 0 && !parseInt(f[2].data + 3, f[2].size - 3, peerVersion))
+			peerVersion = 0;
+		int agreed = 0;
+		if (_binaryProtocol && peerVersion > 0)
+			agreed = (peerVersion < WIRE_VERSION) ? peerVersion : WIRE_VERSION;
+		if (conn->port != 0)
+		{
+			if (agreed > 0)
+				conn->wireVersion = agreed;
+			return;
+		}
+		int port = 0;
+		const uint16_t fromPort = parseInt(f[1].data, f[1].size, port) ? (uint16_t)port : 0;
+		if (fromPort == 0)
+			return;
+		{
+			std::lock_guard<std::mutex> lk(_connMutex);
+			conn->port = fromPort;
+			auto &slot = _connsByKey[conn->ip + ":" + std::to_string(fromPort)];
+			if (!slot || slot->closed)
+				slot = conn;
+		}
+		if (agreed > 0)
+		{
+			conn->wireVersion = agreed;
+			if (!sendFrame(conn, helloPayload()))
+				dropConnection(conn);
+		}
+	}
+
+	// REQ|fromId|fromPort|matchId|[toId]|
+	void LanP2PNode::onTextRequest(const std::shared_ptr<Connection> &conn, const FieldRef *f, size_t n)
+	{
+		int port = 0;
+		const uint16_t fromPort = parseInt(f[1].data, f[1].size, port) ? (uint16_t)port : 0;
+		const FieldRef none = { "", 0 };
+		handleMatchRequest(conn, f[0], fromPort, f[2], n >= 4 ? f[3] : none);
+	}
+
+	// RESP|fromId|matchId|1/0|
+	void LanP2PNode::onTextResponse(const std::shared_ptr<Connection> &conn, const FieldRef *f, size_t n)
+	{
+		(void)n;
+		handleMatchResponse(conn, f[0], f[1], f[2].size == 1 && f[2].data[0] == '1');
+	}
+
+	// INT|fromId|matchId|
+	void LanP2PNode::onTextInterrupt(const std::shared_ptr<Connection> &conn, const FieldRef *f, size_t n)
+	{
+		(void)n;
+		handleMatchInterrupt(conn, f[0], f[1]);
+	}
+
+	// HB|fromId|matchId|
+	void LanP2PNode::onTextHeartbeat(const std::shared_ptr<Connection> &conn, const FieldRef *f, size_t n)
+	{
+		(void)n;
+		handleHeartbeat(conn, f[0], f[1]);
+	}
+
+	// MOVE|x|y|z|޷ʱԣ
+	void LanP2PNode::onTextMove(const std::shared_ptr<Connection> &conn, const FieldRef *f, size_t n)
+	{
+		(void)n;
+		int x, y, z;
+		if (parseInt(f[0].data, f[0].size, x) && parseInt(f[1].data, f[1].size, y) && parseInt(f[2].data, f[2].size, z))
+			handleGameMove(conn, x, y, z);
+	}
+
+	// ϢеIDдʮƷŽõĻ壬֮ıЭͬһ״
+	void LanP2PNode::onBinaryRequest(const std::shared_ptr<Connection> &conn, const char *body)
+	{
+		const uint64_t to = getU64(body + 16);
+		writeWireId(getU64(body), _scratch.ids[0]);
+		writeWireId(getU64(body + 8), _scratch.ids[1]);
+		writeWireId(to, _scratch.ids[2]);
+		const FieldRef fromId = { _scratch.ids[0], 16 }, matchId = { _scratch.ids[1], 16 }, toId = { _scratch.ids[2], to != 0 ? (size_t)16 : 0 };
+		handleMatchRequest(conn, fromId, getU16(body + 24), matchId, toId);
+	}
+
+	void LanP2PNode::onBinaryResponse(const std::shared_ptr<Connection> &conn, const char *body)
+	{
+		writeWireId(getU64(body), _scratch.ids[0]);
+		writeWireId(getU64(body + 8), _scratch.ids[1]);
+		const FieldRef fromId = { _scratch.ids[0], 16 }, matchId = { _scratch.ids[1], 16 };
+		handleMatchResponse(conn, fromId, matchId, body[16] != 0);
+	}
+
+	void LanP2PNode::onBinaryInterrupt(const std::shared_ptr<Connection> &conn, const char *body)
+	{
+		writeWireId(getU64(body), _scratch.ids[0]);
+		writeWireId(getU64(body + 8), _scratch.ids[1]);
+		const FieldRef fromId = { _scratch.ids[0], 16 }, matchId = { _scratch.ids[1], 16 };
+		handleMatchInterrupt(conn, fromId, matchId);
+	}
+
+	void LanP2PNode::onBinaryHeartbeat(const std::shared_ptr<Connection> &conn, const char *body)
+	{
+		writeWireId(getU64(body), _scratch.ids[0]);
+		writeWireId(getU64(body + 8), _scratch.ids[1]);
+		const FieldRef fromId = { _scratch.ids[0], 16 }, matchId = { _scratch.ids[1], 16 };
+		handleHeartbeat(conn, fromId, matchId);
+	}
+
+	void LanP2PNode::onBinaryMove(const std::shared_ptr<Connection> &conn, const char *body)
+	{
+		handleGameMove(conn, (int16_t)getU16(body), (int16_t)getU16(body + 2), (int16_t)getU16(body + 4));
+	}
+
+	// ڶԶ˱вipidͬĶԶˣ÷_peersMutex
+	static const PeerInfo *findPeerLocked(const std::unordered_map<std::string, PeerInfo> &peers, const std::string &ip, const FieldRef &id)
+	{
+		for (auto& kv : peers)
 		{
 			const PeerInfo &p = kv.second;
-			if (p.ip == ip && p.id == id)
-				return p.tcpPort;
+			if (p.ip == ip && fieldEquals(id, p.id))
+				return &p;
 		}
-		return 0;
+		return nullptr;
 	}
 
-	// TCPӴЭ鲢صϲ㣩
-	void LanP2PNode::tcpConnectionHandler(uintptr_t sock, std::string remoteIp)
+	// յƥ󣺸¶Զ˱صϲ㲢ƥԾ
+	void LanP2PNode::handleMatchRequest(const std::shared_ptr<Connection> &conn, const FieldRef &fromId, uint16_t fromPort,
+	                                    const FieldRef &matchId, const FieldRef &toId)
 	{
-		std::string payload;
-		while (_running && tcpRecvFramed(sock, payload))
+		if (fieldEquals(fromId, _nodeId))
+			return; // 
+		if (toId.size != 0 && !fieldEquals(toId, _nodeId))
+			return; // Ŀ겻
+		// Ϣ/Զ˱
+		PeerInfo &pi = _scratch.peer;
+		pi.id.assign(fromId.data, fromId.size);
+		pi.ip = conn->ip;
+		pi.tcpPort = fromPort;
+		pi.lastSeenMs = nowMs();
+		pi.name.clear();
+		buildPeerKey(_scratch.key, conn->ip, fromPort, fromId);
+		_scratch.matchId.assign(matchId.data, matchId.size);
 		{
-			const uint64_t ts = nowMs();
-			if (payload.compare(0, 4, "REQ|") == 0)
+			std::lock_guard<std::mutex> lk(_peersMutex);
+			auto it = _peersByKey.find(_scratch.key);
+			if (it != _peersByKey.end())
 			{
-				// ʽREQ|fromId|fromPort|matchId|[toId]|
-				size_t p1 = payload.find('|', 4);
-				size_t p2 = (p1 != std::string::npos) ? payload.find('|', p1 + 1) : std::string::npos;
-				size_t p3 = (p2 != std::string::npos) ? payload.find('|', p2 + 1) : std::string::npos;
-				size_t p4 = (p3 != std::string::npos) ? payload.find('|', p3 + 1) : std::string::npos;
-				if (p1 != std::string::npos && p2 != std::string::npos && p3 != std::string::npos)
-				{
-					std::string fromId = payload.substr(4, p1 - 4);
-					uint16_t fromPort = 0;
-					try
-					{
-						fromPort = (uint16_t)std::stoi(payload.substr(p1 + 1, p2 - (p1 + 1)));
-					}
-					catch (...)
-					{
-						fromPort = 0;
-					}
-					std::string matchId = payload.substr(p2 + 1, p3 - (p2 + 1));
-					std::string toId;
-					if (p4 != std::string::npos)
-						toId = payload.substr(p3 + 1, p4 - (p3 + 1));
-					if (fromId == _nodeId)
-						continue; // 
-					if (!toId.empty() && toId != _nodeId)
-						continue; // Ŀ겻
-					// Ϣ/Զ˱
-					PeerInfo piMsg;
-					piMsg.id = fromId;
-					piMsg.ip = remoteIp;
-					piMsg.tcpPort = fromPort;
-					piMsg.lastSeenMs = ts;
-					{
-						std::lock_guard<std::mutex> lk(_peersMutex);
-						std::string key = piMsg.ip + ":" + std::to_string(piMsg.tcpPort) + ":" + piMsg.id;
-						auto it = _peersByKey.find(key);
-						if (it != _peersByKey.end())
-							piMsg.name = it->second.name;
-						_peersByKey[key] = piMsg;
-					}
-					if (_onMatchRequest)
-						_onMatchRequest(piMsg, matchId);
-					// ƥΪԾ
-					markMatchActive(remoteIp, fromPort, fromId, matchId);
-				}
+				pi.name = it->second.name;
+				it->second = pi;
 			}
-			else if (payload.compare(0, 5, "RESP|") == 0)
+			else
 			{
-				// ʽRESP|fromId|matchId|1/0|
-				size_t p1 = payload.find('|', 5);
-				size_t p2 = payload.find('|', p1 + 1);
-				size_t p3 = payload.find('|', p2 + 1);
-				if (p1 != std::string::npos && p2 != std::string::npos && p3 != std::string::npos)
-				{
-					std::string fromId = payload.substr(5, p1 - 5);
-					std::string matchId = payload.substr(p1 + 1, p2 - (p1 + 1));
-					bool accepted = payload.substr(p2 + 1, p3 - (p2 + 1)) == "1";
-					uint16_t ptcp = findPeerTcpPort(remoteIp, fromId);
-					PeerInfo pi;
-					pi.id = fromId;
-					pi.ip = remoteIp;
-					pi.tcpPort = ptcp;
-					pi.lastSeenMs = ts;
-					{
-						std::lock_guard<std::mutex> lk(_peersMutex);
-						for (auto& kv : _peersByKey)
-						{
-							const PeerInfo &pr = kv.second;
-							if (pr.ip == remoteIp && pr.id == fromId)
-							{
-								pi.name = pr.name;
-								break;
-							}
-						}
-					}
-					if (_onMatchResponse)
-						_onMatchResponse(pi, accepted, matchId);
-					if (!accepted)
-					{
-						clearMatch(remoteIp, ptcp, fromId, matchId, false);
-					}
-				}
+				_peersByKey.emplace(_scratch.key, pi);
 			}
-			else if (payload.compare(0, 4, "INT|") == 0)
+		}
+		if (_onMatchRequest)
+			_onMatchRequest(pi, _scratch.matchId);
+		// ƥΪԾ
+		{
+			std::lock_guard<std::mutex> lk(_peersMutex);
+			auto it = _matchesByKey.find(_scratch.key);
+			if (it == _matchesByKey.end())
+				it = _matchesByKey.emplace(_scratch.key, MatchState()).first;
+			it->second.matchId = _scratch.matchId;
+			it->second.lastHbMs = nowMs();
+		}
+	}
+
+	// յƥӦصϲ㣻ܾʱƥ
+	void LanP2PNode::handleMatchResponse(const std::shared_ptr<Connection> &conn, const FieldRef &fromId, const FieldRef &matchId,
+	                                     bool accepted)
+	{
+		PeerInfo &pi = _scratch.peer;
+		pi.id.assign(fromId.data, fromId.size);
+		pi.ip = conn->ip;
+		pi.tcpPort = 0;
+		pi.lastSeenMs = nowMs();
+		pi.name.clear();
+		{
+			std::lock_guard<std::mutex> lk(_peersMutex);
+			if (const PeerInfo *p = findPeerLocked(_peersByKey, conn->ip, fromId))
 			{
-				// ʽINT|fromId|matchId|
-				size_t p1 = payload.find('|', 4);
-				size_t p2 = payload.find('|', p1 + 1);
-				if (p1 != std::string::npos && p2 != std::string::npos)
-				{
-					std::string fromId = payload.substr(4, p1 - 4);
-					if (fromId == _nodeId)
-						continue;
-					std::string matchId = payload.substr(p1 + 1, p2 - (p1 + 1));
-					uint16_t ptcp = findPeerTcpPort(remoteIp, fromId);
-					PeerInfo pi;
-					pi.id = fromId;
-					pi.ip = remoteIp;
-					pi.tcpPort = ptcp;
-					pi.lastSeenMs = ts;
-					{
-						std::lock_guard<std::mutex> lk(_peersMutex);
-						for (auto& kv : _peersByKey)
-						{
-							const PeerInfo &pr = kv.second;
-							if (pr.ip == remoteIp && pr.id == fromId)
-							{
-								pi.name = pr.name;
-								break;
-							}
-						}
-					}
-					if (_onMatchInterrupted)
-						_onMatchInterrupted(pi, matchId);
-					clearMatch(remoteIp, ptcp, fromId, matchId, false);
-				}
+				pi.tcpPort = p->tcpPort;
+				pi.name = p->name;
 			}
-			else if (payload.compare(0, 3, "HB|") == 0)
+		}
+		_scratch.matchId.assign(matchId.data, matchId.size);
+		if (_onMatchResponse)
+			_onMatchResponse(pi, accepted, _scratch.matchId);
+		if (!accepted)
+		{
+			buildPeerKey(_scratch.key, conn->ip, pi.tcpPort, fromId);
+			clearMatchByKey(_scratch.key, pi.ip, pi.tcpPort, pi.id, _scratch.matchId, false);
+		}
+	}
+
+	// յƥжϣصϲ㲢ƥ
+	void LanP2PNode::handleMatchInterrupt(const std::shared_ptr<Connection> &conn, const FieldRef &fromId, const FieldRef &matchId)
+	{
+		if (fieldEquals(fromId, _nodeId))
+			return;
+		PeerInfo &pi = _scratch.peer;
+		pi.id.assign(fromId.data, fromId.size);
+		pi.ip = conn->ip;
+		pi.tcpPort = 0;
+		pi.lastSeenMs = nowMs();
+		pi.name.clear();
+		{
+			std::lock_guard<std::mutex> lk(_peersMutex);
+			if (const PeerInfo *p = findPeerLocked(_peersByKey, conn->ip, fromId))
 			{
-				// ʽHB|fromId|matchId|
-				size_t p1 = payload.find('|', 3);
-				size_t p2 = (p1 != std::string::npos) ? payload.find('|', p1 + 1) : std::string::npos;
-				if (p1 != std::string::npos && p2 != std::string::npos)
-				{
-					std::string fromId = payload.substr(3, p1 - 3);
-					std::string matchId = payload.substr(p1 + 1, p2 - (p1 + 1));
-					std::string key = remoteIp + ":" + std::to_string(findPeerTcpPort(remoteIp, fromId)) + ":" + fromId;
-					{
-						std::lock_guard<std::mutex> lk(_peersMutex);
-						auto it = _matchesByKey.find(key);
-						if (it != _matchesByKey.end() && it->second.matchId == matchId)
-							it->second.lastHbMs = nowMs();
-					}
-				}
+				pi.tcpPort = p->tcpPort;
+				pi.name = p->name;
 			}
-			else if (payload.compare(0, 5, "MOVE|") == 0)
+		}
+		_scratch.matchId.assign(matchId.data, matchId.size);
+		if (_onMatchInterrupted)
+			_onMatchInterrupted(pi, _scratch.matchId);
+		buildPeerKey(_scratch.key, conn->ip, pi.tcpPort, fromId);
+		clearMatchByKey(_scratch.key, pi.ip, pi.tcpPort, pi.id, _scratch.matchId, false);
+	}
+
+	// յˢƥʱ
+	void LanP2PNode::handleHeartbeat(const std::shared_ptr<Connection> &conn, const FieldRef &fromId, const FieldRef &matchId)
+	{
+		std::lock_guard<std::mutex> lk(_peersMutex);
+		const PeerInfo *p = findPeerLocked(_peersByKey, conn->ip, fromId);
+		buildPeerKey(_scratch.key, conn->ip, p ? p->tcpPort : 0, fromId);
+		auto it = _matchesByKey.find(_scratch.key);
+		if (it != _matchesByKey.end() && fieldEquals(matchId, it->second.matchId))
+			it->second.lastHbMs = nowMs();
+	}
+
+	// յӣԴIPҵԶϢصϲ
+	void LanP2PNode::handleGameMove(const std::shared_ptr<Connection> &conn, int x, int y, int z)
+	{
+		PeerInfo &pi = _scratch.peer;
+		bool found = false;
+		{
+			std::lock_guard<std::mutex> lk(_peersMutex);
+			for (auto& kv : _peersByKey)
 			{
-				// ʽMOVE|x|y|z|
-				size_t p1 = payload.find('|', 5);
-				size_t p2 = (p1 != std::string::npos) ? payload.find('|', p1 + 1) : std::string::npos;
-				size_t p3 = (p2 != std::string::npos) ? payload.find('|', p2 + 1) : std::string::npos;
-				if (p1 != std::string::npos && p2 != std::string::npos && p3 != std::string::npos)
+				const PeerInfo &p = kv.second;
+				if (p.ip == conn->ip)
 				{
-					try
-					{
-						int x = std::stoi(payload.substr(5, p1 - 5));
-						int y = std::stoi(payload.substr(p1 + 1, p2 - (p1 + 1)));
-						int z = std::stoi(payload.substr(p2 + 1, p3 - (p2 + 1)));
-
-						PeerInfo pi;
-						pi.ip = remoteIp;
-						pi.lastSeenMs = ts;
-						{
-							std::lock_guard<std::mutex> lk(_peersMutex);
-							for (auto& kv : _peersByKey)
-							{
-								const PeerInfo &p = kv.second;
-								if (p.ip == remoteIp)
-								{
-									pi = p;
-									break;
-								}
-							}
-						}
-						if (_onGameMove)
-						{
-							_onGameMove(pi, x, y, z);
-						}
-					}
-					catch (...) { /* תʧܺ */ }
+					pi = p;
+					found = true;
+					break;
 				}
-
 			}
 		}
-		closesock(sock);
+		if (!found)
+		{
+			pi.id.clear();
+			pi.name.clear();
+			pi.ip = conn->ip;
+			pi.tcpPort = 0;
+			pi.lastSeenMs = nowMs();
+		}
+		if (_onGameMove)
+		{
+			_onGameMove(pi, x, y, z);
+		}
 	}
 
-	// TCPб߽֡
-	bool LanP2PNode::tcpSendFramed(uintptr_t sock, const std::string &payload)
+	// ַһ֡ģ׼طã
+	void LanP2PNode::injectFrame(const std::string &remoteIp, const char *data, size_t size)
 	{
-		uint32_t n = (uint32_t)payload.size();
-		uint32_t be = htonl(n);
-		int off = 0;
-		int r = 0;
-		while (off < 4)
+		if (!_injectConn)
 		{
-			r = send(static_cast<SOCKET>(sock), ((const char *)&be) + off, 4 - off, 0);
-			if (r <= 0)
-				return false;
-			off += r;
+			// ѹرյӣķͣHELLOӦֱʧ
+			_injectConn = std::make_shared<Connection>();
+			_injectConn->closed = true;
 		}
-		off = 0;
-		while (off < (int)n)
+		_injectConn->ip = remoteIp;
+		dispatchFrame(_injectConn, data, size);
+	}
+
+	// dataʼͷгַ֡֡ĵֽ֡ʱfalse
+	bool LanP2PNode::dispatchFrames(const std::shared_ptr<Connection> &conn, const char *data, size_t size, size_t &consumed)
+	{
+		size_t off = 0;
+		while (size - off >= 4)
 		{
-			r = send(static_cast<SOCKET>(sock), payload.data() + off, (int)n - off, 0);
-			if (r <= 0)
+			uint32_t be = 0;
+			std::memcpy(&be, data + off, 4);
+			uint32_t n = ntohl(be);
+			if (n > MAX_FRAME_SIZE)
 				return false;
-			off += r;
+			if (size - off - 4 < n)
+				break;
+			_framesReceived.fetch_add(1, std::memory_order_relaxed);
+			dispatchFrame(conn, data + off + 4, n);
+			off += 4 + (size_t)n;
 		}
+		consumed = off;
 		return true;
 	}
 
-	// TCPб߽֡
-	bool LanP2PNode::tcpRecvFramed(uintptr_t sock, std::string& outPayload)
+	// ѵݣͷַ֡֡Զ˹رա֡ʱfalse
+	// ˵ܻݣޣδΪѶգʡȥһWSAEWOULDBLOCKrecv
+	// ֱ֡ڽջϷַֻпζȡİ֡ſӵinBuf
+	bool LanP2PNode::tcpReadFrames(const std::shared_ptr<Connection> &conn)
 	{
-		uint32_t be =0; int got =0; int r =0;
-		while (got <4) { r = recv(static_cast<SOCKET>(sock), ((char*)&be) + got,4 - got,0); if (r <=0) return false; got += r; }
-		uint32_t n = ntohl(be);
-		// ֡ȣֹ˷ͳ֡
-		const uint32_t MAX_FRAME_SIZE = 8192;
-		if (n > MAX_FRAME_SIZE) return false;
-		outPayload.resize(n);
-		int off =0;
-		while (off < (int)n) { r = recv(static_cast<SOCKET>(sock), &outPayload[off], (int)n - off,0); if (r <=0) return false; off += r; }
+		for (int reads = 0; reads < MAX_READS_PER_EVENT; ++reads)
+		{
+			int r = recv(static_cast<SOCKET>(conn->sock), _readBuf.data(), (int)_readBuf.size(), 0);
+			_recvCalls.fetch_add(1, std::memory_order_relaxed);
+			if (r == 0)
+				return false;
+			if (r < 0)
+			{
+				if (WSAGetLastError() != WSAEWOULDBLOCK)
+					return false;
+				break;
+			}
+			size_t consumed = 0;
+			if (conn->inBuf.empty())
+			{
+				if (!dispatchFrames(conn, _readBuf.data(), (size_t)r, consumed))
+					return false;
+				conn->inBuf.assign(_readBuf.data() + consumed, (size_t)r - consumed);
+			}
+			else
+			{
+				conn->inBuf.append(_readBuf.data(), (size_t)r);
+				if (!dispatchFrames(conn, conn->inBuf.data(), conn->inBuf.size(), consumed))
+					return false;
+				conn->inBuf.erase(0, consumed);
+			}
+			if ((size_t)r < _readBuf.size())
+				break;
+		}
 		return true;
 	}
 
-	// ƥ󣨴ԣ
-	bool LanP2PNode::sendMatchRequest(const std::string &peerIp, uint16_t peerTcpPort, const std::string &matchId)
+	// TCPб߽֡ͣͷƴһηͣϲᱻNagle𿪵ȴ
+	bool LanP2PNode::tcpSendFramed(uintptr_t sock, const std::string &payload)
 	{
-		for (int attempt = 0; attempt < _maxSendRetries; ++attempt)
+		std::string frame;
+		frame.reserve(4 + payload.size());
+		appendFrame(frame, payload);
+		int off = 0;
+		int r = 0;
+		while (off < (int)frame.size())
 		{
-			uintptr_t s = (uintptr_t)socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-			if ((SOCKET)s == INVALID_SOCKET)
-				return false;
-			sockaddr_in addr{};
-			addr.sin_family = AF_INET;
-			addr.sin_port = htons(peerTcpPort);
-			addr.sin_addr.s_addr = inet_addr(peerIp.c_str());
-			if (connect(static_cast<SOCKET>(s), (sockaddr * )&addr, sizeof(addr)) != 0)
+			r = send(static_cast<SOCKET>(sock), frame.data() + off, (int)frame.size() - off, 0);
+			_sendCalls.fetch_add(1, std::memory_order_relaxed);
+			if (r > 0)
 			{
-				closesock(s);
-				std::this_thread::sleep_for(std::chrono::milliseconds(100));
+				off += r;
 				continue;
 			}
-			std::string toId;
+			if (r < 0 && WSAGetLastError() == WSAEWOULDBLOCK)
 			{
-				std::lock_guard<std::mutex> lk(_peersMutex);
-				for (auto& kv : _peersByKey)
-				{
-					const PeerInfo &p = kv.second;
-					if (p.ip == peerIp && p.tcpPort == peerTcpPort)
-					{
-						toId = p.id;
-						break;
-					}
-				}
+				// ׽ֵķͻֻڷ߳ȴдռ¼ѭ
+				WSAPOLLFD pfd{};
+				pfd.fd = static_cast<SOCKET>(sock);
+				pfd.events = POLLWRNORM;
+				if (WSAPoll(&pfd, 1, SEND_WAIT_MS) > 0 && (pfd.revents & POLLWRNORM))
+					continue;
 			}
-			std::ostringstream oss;
-			if (toId.empty())
-				oss << "REQ|" << _nodeId << "|" << _tcpPort << "|" << matchId << "|";
-			else
-				oss << "REQ|" << _nodeId << "|" << _tcpPort << "|" << matchId << "|" << toId << "|";
-			bool ok = tcpSendFramed(s, oss.str());
-			closesock(s);
-			if (ok)
+			return false;
+		}
+		return true;
+	}
+
+	// ƥ
+	bool LanP2PNode::sendMatchRequest(const std::string &peerIp, uint16_t peerTcpPort, const std::string &matchId)
+	{
+		std::string toId;
+		{
+			std::lock_guard<std::mutex> lk(_peersMutex);
+			for (auto& kv : _peersByKey)
 			{
-				if (!toId.empty())
-					markMatchActive(peerIp, peerTcpPort, toId, matchId);
-				return true;
+				const PeerInfo &p = kv.second;
+				if (p.ip == peerIp && p.tcpPort == peerTcpPort)
+				{
+					toId = p.id;
+					break;
+				}
 			}
-			std::this_thread::sleep_for(std::chrono::milliseconds(100));
 		}
-		return false;
+		std::ostringstream oss;
+		if (toId.empty())
+			oss << "REQ|" << _nodeId << "|" << _tcpPort << "|" << matchId << "|";
+		else
+			oss << "REQ|" << _nodeId << "|" << _tcpPort << "|" << matchId << "|" << toId << "|";
+		std::string bin = wireIdMessage(WIRE_REQ, 26, _nodeId, matchId);
+		uint64_t to = 0;
+		if (!bin.empty() && (toId.empty() || parseWireId(toId, to)))
+		{
+			putU64(bin, to);
+			putU16(bin, _tcpPort);
+		}
+		else
+		{
+			bin.clear();
+		}
+		if (!sendToPeer(peerIp, peerTcpPort, oss.str(), bin))
+			return false;
+		if (!toId.empty())
+			markMatchActive(peerIp, peerTcpPort, toId, matchId);
+		return true;
 	}
 
-	// Ӧƥ󣨴ԣ
+	// Ӧƥ
 	bool LanP2PNode::respondToMatch(const std::string &peerIp, uint16_t peerTcpPort, const std::string &matchId,
 	                                bool accept)
 	{
-		for (int attempt = 0; attempt < _maxSendRetries; ++attempt)
+		std::ostringstream oss;
+		oss << "RESP|" << _nodeId << "|" << matchId << "|" << (accept ? "1" : "0") << "|";
+		std::string bin = wireIdMessage(WIRE_RESP, 17, _nodeId, matchId);
+		if (!bin.empty())
+			bin.push_back(accept ? 1 : 0);
+		return sendToPeer(peerIp, peerTcpPort, oss.str(), bin);
+	}
+
+	// ƥж
+	bool LanP2PNode::interruptMatch(const std::string &peerIp, uint16_t peerTcpPort, const std::string &matchId)
+	{
+		std::ostringstream oss;
+		oss << "INT|" << _nodeId << "|" << matchId << "|";
+		return sendToPeer(peerIp, peerTcpPort, oss.str(), wireIdMessage(WIRE_INT, 16, _nodeId, matchId));
+	}
+
+	// TCP
+	bool LanP2PNode::sendTcpHeartbeat(const std::string &ip, uint16_t port, const std::string &matchId)
+	{
+		std::ostringstream oss;
+		oss << "HB|" << _nodeId << "|" << matchId << "|";
+		return sendToPeer(ip, port, oss.str(), wireIdMessage(WIRE_HB, 16, _nodeId, matchId));
+	}
+
+	// ȡõԶ˵ĳӣֱӸãӡHELLO¼ѭ
+	std::shared_ptr<LanP2PNode::Connection> LanP2PNode::getConnection(const std::string &ip, uint16_t port)
+	{
+		const std::string key = ip + ":" + std::to_string(port);
 		{
-			uintptr_t s = (uintptr_t)socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-			if ((SOCKET)s == INVALID_SOCKET)
-				return false;
-			sockaddr_in addr{};
-			addr.sin_family = AF_INET;
-			addr.sin_port = htons(peerTcpPort);
-			addr.sin_addr.s_addr = inet_addr(peerIp.c_str());
-			if (connect(static_cast<SOCKET>(s), (sockaddr * )&addr, sizeof(addr)) != 0)
+			std::lock_guard<std::mutex> lk(_connMutex);
+			auto it = _connsByKey.find(key);
+			if (it != _connsByKey.end() && !it->second->closed)
+				return it->second;
+		}
+		uintptr_t s = (uintptr_t)socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+		if ((SOCKET)s == INVALID_SOCKET)
+			return nullptr;
+		sockaddr_in addr{};
+		addr.sin_family = AF_INET;
+		addr.sin_port = htons(port);
+		addr.sin_addr.s_addr = inet_addr(ip.c_str());
+		if (connect(static_cast<SOCKET>(s), (sockaddr * )&addr, sizeof(addr)) != 0)
+		{
+			closesock(s);
+			return nullptr;
+		}
+		setNoDelay(s);
+		if (!tcpSendFramed(s, helloPayload()))
+		{
+			closesock(s);
+			return nullptr;
+		}
+		setNonBlocking(s);
+		auto conn = std::make_shared<Connection>();
+		conn->sock = s;
+		conn->ip = ip;
+		conn->port = port;
+		{
+			std::lock_guard<std::mutex> lk(_connMutex);
+			if (!_running)
 			{
 				closesock(s);
-				std::this_thread::sleep_for(std::chrono::milliseconds(100));
-				continue;
+				return nullptr;
 			}
-			std::ostringstream oss;
-			oss << "RESP|" << _nodeId << "|" << matchId << "|" << (accept ? "1" : "0") << "|";
-			bool ok = tcpSendFramed(s, oss.str());
-			closesock(s);
-			if (ok)
-				return true;
-			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+			// ʱȵǼǵ
+			auto it = _connsByKey.find(key);
+			if (it != _connsByKey.end() && !it->second->closed)
+			{
+				closesock(s);
+				return it->second;
+			}
+			// һӶϿʱû֡ӵǰ棬һ𽻸¼ѭ
+			auto rt = _retryFrames.find(key);
+			if (rt != _retryFrames.end())
+			{
+				conn->outBuf.swap(rt->second.frames);
+				conn->outQueued = true;
+				_flushConns.push_back(conn);
+				_retryFrames.erase(rt);
+			}
+			_connsByKey[key] = conn;
+			_pendingConns.push_back(conn);
 		}
-		return false;
+		wakeReactor();
+		return conn;
 	}
 
-	// ƥжϣԣ
-	bool LanP2PNode::interruptMatch(const std::string &peerIp, uint16_t peerTcpPort, const std::string &matchId)
+	// ӷһϢЭ̶ЭbinaryǿʱbinarytextʧЧʱرղ
+	bool LanP2PNode::sendToPeer(const std::string &ip, uint16_t port, const std::string &text, const std::string &binary)
 	{
 		for (int attempt = 0; attempt < _maxSendRetries; ++attempt)
 		{
-			uintptr_t s = (uintptr_t)socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-			if ((SOCKET)s == INVALID_SOCKET)
-				return false;
-			sockaddr_in addr{};
-			addr.sin_family = AF_INET;
-			addr.sin_port = htons(peerTcpPort);
-			addr.sin_addr.s_addr = inet_addr(peerIp.c_str());
-			if (connect(static_cast<SOCKET>(s), (sockaddr * )&addr, sizeof(addr)) != 0)
+			std::shared_ptr<Connection> conn = getConnection(ip, port);
+			if (conn)
 			{
-				closesock(s);
-				std::this_thread::sleep_for(std::chrono::milliseconds(100));
-				continue;
+				const bool useBinary = !binary.empty() && _binaryProtocol && conn->wireVersion > 0;
+				if (sendFrame(conn, useBinary ? binary : text))
+					return true;
+				dropConnection(conn);
 			}
-			std::ostringstream oss;
-			oss << "INT|" << _nodeId << "|" << matchId << "|";
-			bool ok = tcpSendFramed(s, oss.str());
-			closesock(s);
-			if (ok)
-				return true;
 			std::this_thread::sleep_for(std::chrono::milliseconds(100));
 		}
 		return false;
 	}
 
-	// TCPԣ
-	bool LanP2PNode::sendTcpHeartbeat(const std::string &ip, uint16_t port, const std::string &matchId)
+	// Ϸһ֡BatchedŶӵ֡ʱֻ׷ӵͶУ¼ѭʧܻر
+	// Directڵ߳sendͻʱʣಿֽ¼ѭoutBuf+д¼
+	// ͷsendMutexٵһݵĶԶ˲¼ѭӵϵȴ
+	bool LanP2PNode::sendFrame(const std::shared_ptr<Connection> &conn, const std::string &payload)
 	{
-		for (int attempt = 0; attempt < _maxSendRetries; ++attempt)
+		bool ok = true;
+		bool schedule = false;
+		uint64_t waitFor = 0; // DirectoutSentֵ֡ĩβ㷢
 		{
-			uintptr_t s = (uintptr_t)socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-			if ((SOCKET)s == INVALID_SOCKET)
-				return false;
-			sockaddr_in addr{};
-			addr.sin_family = AF_INET;
-			addr.sin_port = htons(port);
-			addr.sin_addr.s_addr = inet_addr(ip.c_str());
-			if (connect(static_cast<SOCKET>(s), (sockaddr * )&addr, sizeof(addr)) != 0)
+			std::lock_guard<std::mutex> lk(conn->sendMutex);
+			if (conn->closed)
 			{
-				closesock(s);
-				std::this_thread::sleep_for(std::chrono::milliseconds(100));
+				ok = false;
+			}
+			else if (!conn->outBuf.empty() || (_ioMode == IoMode::Batched && _reactorReady))
+			{
+				ok = conn->outBuf.size() + payload.size() <= MAX_QUEUED_BYTES;
+				if (ok)
+				{
+					appendFrame(conn->outBuf, payload);
+					schedule = !conn->outQueued;
+					conn->outQueued = true;
+					if (_ioMode == IoMode::Direct)
+						waitFor = conn->outSent - conn->outHead + conn->outBuf.size();
+				}
+			}
+			else if (!_reactorReady)
+			{
+				// û¼ѭԽֻ֣ڱ߳ȿд
+				ok = tcpSendFramed(conn->sock, payload);
+			}
+			else
+			{
+				std::string frame;
+				frame.reserve(4 + payload.size());
+				appendFrame(frame, payload);
+				size_t off = 0;
+				while (off < frame.size())
+				{
+					int r = send(static_cast<SOCKET>(conn->sock), frame.data() + off, (int)(frame.size() - off), 0);
+					_sendCalls.fetch_add(1, std::memory_order_relaxed);
+					if (r > 0)
+					{
+						off += (size_t)r;
+						continue;
+					}
+					ok = r < 0 && WSAGetLastError() == WSAEWOULDBLOCK;
+					break;
+				}
+				if (ok && off < frame.size())
+				{
+					// ֡ӲѷĲ֣ӶϿʱһ֡֡
+					conn->outBuf.swap(frame);
+					conn->outHead = off;
+					conn->outSent += off;
+					schedule = !conn->outQueued;
+					conn->outQueued = true;
+					waitFor = conn->outSent - off + conn->outBuf.size();
+				}
+			}
+		}
+		if (schedule)
+			scheduleFlush(conn);
+		if (ok && waitFor > 0)
+		{
+			std::unique_lock<std::mutex> lk(conn->sendMutex);
+			conn->sendDone.wait_for(lk, std::chrono::milliseconds(SEND_WAIT_MS), [&conn, waitFor]()
+			{
+				return conn->closed || conn->outSent >= waitFor;
+			});
+			ok = conn->outSent >= waitFor;
+			if (!ok && conn->port != 0)
+			{
+				// ѶϿԶ˳ʱ䲻֡δ֡һ¼ѭرʱת벹Уɵ÷ط
+				lk.unlock();
+				dropConnection(conn);
+				ok = true;
+			}
+		}
+		if (ok)
+			_framesSent.fetch_add(1, std::memory_order_relaxed);
+		return ok;
+	}
+
+	// HELLOģ֪ڵID˿ڣöЭʱֵ֧İ汾
+	std::string LanP2PNode::helloPayload() const
+	{
+		std::ostringstream oss;
+		oss << "HELLO|" << _nodeId << "|" << _tcpPort << "|";
+		if (_binaryProtocol)
+			oss << "BIN" << (int)WIRE_VERSION << "|";
+		return oss.str();
+	}
+
+	// ӵǼǵ¼ѭĴббɿձΪǿʱŻѣһֻһ
+	void LanP2PNode::scheduleFlush(const std::shared_ptr<Connection> &conn)
+	{
+		bool wake;
+		{
+			std::lock_guard<std::mutex> lk(_connMutex);
+			wake = _flushConns.empty();
+			_flushConns.push_back(conn);
+		}
+		if (wake)
+			wakeReactor();
+	}
+
+	// ӷͶеֻ֡¼ѭ̵߳ãͻʱʣಿֲȿдfalse
+	bool LanP2PNode::flushConnection(const std::shared_ptr<Connection> &conn)
+	{
+		std::lock_guard<std::mutex> lk(conn->sendMutex);
+		if (conn->closed || conn->sock == INVALID_SOCK)
+			return true;
+		bool ok = true;
+		size_t off = conn->outHead;
+		while (off < conn->outBuf.size())
+		{
+			int r = send(static_cast<SOCKET>(conn->sock), conn->outBuf.data() + off, (int)(conn->outBuf.size() - off), 0);
+			_sendCalls.fetch_add(1, std::memory_order_relaxed);
+			if (r > 0)
+			{
+				off += (size_t)r;
 				continue;
 			}
-			std::ostringstream oss;
-			oss << "HB|" << _nodeId << "|" << matchId << "|";
-			bool ok = tcpSendFramed(s, oss.str());
-			closesock(s);
-			if (ok)
-				return true;
-			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+			ok = r < 0 && WSAGetLastError() == WSAEWOULDBLOCK;
+			break;
 		}
-		return false;
+		conn->outSent += off - conn->outHead;
+		if (off > conn->outHead)
+			conn->sendDone.notify_all();
+		// ֻɾ֡һ֡ڶףӶϿʱ֡
+		const size_t done = completeFrames(conn->outBuf, off);
+		conn->outBuf.erase(0, done);
+		conn->outHead = off - done;
+		// ʣʱoutQueuedΪtrueֻ֡׷ӣɿд¼
+		conn->wantWrite = !conn->outBuf.empty();
+		conn->outQueued = conn->wantWrite;
+		return ok;
+	}
+
+	// ʧЧȡǼǣ׽¼ѭرգֻshutdownһ־
+	void LanP2PNode::dropConnection(const std::shared_ptr<Connection> &conn)
+	{
+		if (conn->closed.exchange(true))
+			return;
+		{
+			std::lock_guard<std::mutex> lk(_connMutex);
+			if (conn->port != 0)
+			{
+				auto it = _connsByKey.find(conn->ip + ":" + std::to_string(conn->port));
+				if (it != _connsByKey.end() && it->second == conn)
+					_connsByKey.erase(it);
+			}
+		}
+		std::lock_guard<std::mutex> lk(conn->sendMutex);
+		if (conn->sock != INVALID_SOCK)
+			shutdown(static_cast<SOCKET>(conn->sock), SD_BOTH);
+		conn->sendDone.notify_all();
+	}
+
+	// رӣֻ¼ѭ̵߳ãͷsendMutexڼclosedرձ֤ѹرգܱãľ
+	// ѵǼǶ˿ڵϻû֡ת벹УȴеDirectͷ֮أ֡ѽУ
+	void LanP2PNode::closeConnection(const std::shared_ptr<Connection> &conn)
+	{
+		dropConnection(conn);
+		std::string unsent;
+		{
+			std::lock_guard<std::mutex> lk(conn->sendMutex);
+			if (conn->sock != INVALID_SOCK)
+			{
+				closesock(conn->sock);
+				conn->sock = INVALID_SOCK;
+			}
+			if (conn->port != 0 && !conn->outBuf.empty())
+			{
+				unsent.swap(conn->outBuf);
+				conn->outSent += unsent.size() - conn->outHead;
+				conn->outHead = 0;
+				conn->sendDone.notify_all();
+			}
+			conn->outQueued = false;
+			conn->wantWrite = false;
+		}
+		if (!unsent.empty())
+			queueRetryFrames(conn->ip, conn->port, unsent);
+	}
+
+	// ѶϿδ֡벹УԶip:portϲԭ˳
+	void LanP2PNode::queueRetryFrames(const std::string &ip, uint16_t port, std::string &frames)
+	{
+		std::lock_guard<std::mutex> lk(_connMutex);
+		if (!_running)
+		{
+			CHESS_LOG_WARN("[LanP2PNode][WARN] ڵֹͣ%s:%u%lluֽδ֡", ip.c_str(), (unsigned)port,
+			                (unsigned long long)frames.size());
+			return;
+		}
+		RetryFrames &r = _retryFrames[ip + ":" + std::to_string(port)];
+		if (r.frames.size() + frames.size() > MAX_QUEUED_BYTES)
+		{
+			CHESS_LOG_WARN("[LanP2PNode][WARN] %s:%u%lluֽ", ip.c_str(), (unsigned)port,
+			                (unsigned long long)frames.size());
+			return;
+		}
+		r.ip = ip;
+		r.port = port;
+		r.frames.append(frames);
+		r.attempts = 0;
+	}
+
+	// в֡ĶԶˣά̵߳ãconnectϣgetConnectionнӹ֡
+	// ӣϿѱؽ׷ӵķͶУ_maxSendRetries
+	void LanP2PNode::resendRetryFrames()
+	{
+		std::vector<std::pair<std::string, uint16_t>> targets;
+		{
+			std::lock_guard<std::mutex> lk(_connMutex);
+			for (auto& kv : _retryFrames)
+				targets.emplace_back(kv.second.ip, kv.second.port);
+		}
+		for (auto& t : targets)
+		{
+			std::shared_ptr<Connection> conn = getConnection(t.first, t.second);
+			const std::string key = t.first + ":" + std::to_string(t.second);
+			std::string frames;
+			{
+				std::lock_guard<std::mutex> lk(_connMutex);
+				auto it = _retryFrames.find(key);
+				if (it == _retryFrames.end())
+					continue;
+				if (!conn)
+				{
+					if (++it->second.attempts >= _maxSendRetries)
+					{
+						CHESS_LOG_WARN("[LanP2PNode][WARN] ޷%s%lluֽδ֡", key.c_str(),
+						                (unsigned long long)it->second.frames.size());
+						_retryFrames.erase(it);
+					}
+					continue;
+				}
+				frames.swap(it->second.frames);
+				_retryFrames.erase(it);
+			}
+			bool schedule = false;
+			{
+				std::lock_guard<std::mutex> lk(conn->sendMutex);
+				if (!conn->closed)
+				{
+					conn->outBuf.append(frames);
+					schedule = !conn->outQueued;
+					conn->outQueued = true;
+					frames.clear();
+				}
+			}
+			if (schedule)
+				scheduleFlush(conn);
+			if (!frames.empty())
+				queueRetryFrames(t.first, t.second, frames);
+		}
+	}
+
+	// WSAPollе¼ѭӴֹͣ
+	void LanP2PNode::wakeReactor()
+	{
+		std::lock_guard<std::mutex> lk(_connMutex);
+		if (_wakePort == 0)
+			return;
+		sockaddr_in a{};
+		a.sin_family = AF_INET;
+		a.sin_port = htons(_wakePort);
+		a.sin_addr.s_addr = inet_addr("127.0.0.1");
+		sendto(static_cast<SOCKET>(_wakeSock), "", 1, 0, (sockaddr *)&a, sizeof(a));
+	}
+
+	// շͳƿ
+	LanP2PNode::IoStats LanP2PNode::getIoStats() const
+	{
+		IoStats st;
+		st.framesSent = _framesSent.load(std::memory_order_relaxed);
+		st.sendCalls = _sendCalls.load(std::memory_order_relaxed);
+		st.framesReceived = _framesReceived.load(std::memory_order_relaxed);
+		st.recvCalls = _recvCalls.load(std::memory_order_relaxed);
+		return st;
 	}
 
 	// ߣǰʱ
@@ -878,9 +1711,9 @@ namespace lanp2p
 					if ((now - it->second.lastSeenMs) > _peerStaleMs)
 					{
 						const PeerInfo &p = it->second;
-						std::printf("[LanP2PNode][DEBUG] ʱƳ peer (DISCά): id=%s ip=%s port=%u lastSeenMs=%llu nowMs=%llu staleMs=%llu\n",
-						            p.id.c_str(), p.ip.c_str(), (unsigned)p.tcpPort,
-						            (unsigned long long)p.lastSeenMs, (unsigned long long)now, (unsigned long long)_peerStaleMs);
+						CHESS_LOG_DEBUG("[LanP2PNode][DEBUG] ʱƳ peer (DISCά): id=%s ip=%s port=%u lastSeenMs=%llu nowMs=%llu staleMs=%llu",
+						                p.id.c_str(), p.ip.c_str(), (unsigned)p.tcpPort,
+						                (unsigned long long)p.lastSeenMs, (unsigned long long)now, (unsigned long long)_peerStaleMs);
 						it = _peersByKey.erase(it);
 					}
 					else ++it;
@@ -935,15 +1768,18 @@ namespace lanp2p
 					size_t p2 = (p1 == std::string::npos) ? std::string::npos : key.find(':', p1 + 1);
 					if (p2 != std::string::npos)
 						peerId = key.substr(p2 + 1);
-					std::printf("[LanP2PNode][DEBUG] ʱƳ peer (HB ʱ): id=%s ip=%s port=%u matchId=%s lastHbMs=%llu nowMs=%llu timeoutMs=%llu\n",
-					            peerId.c_str(), ip.c_str(), (unsigned)port, matchId.c_str(),
-					            (unsigned long long)last, (unsigned long long)now2, (unsigned long long)_matchHeartbeatTimeoutMs);
+					CHESS_LOG_DEBUG("[LanP2PNode][DEBUG] ʱƳ peer (HB ʱ): id=%s ip=%s port=%u matchId=%s lastHbMs=%llu nowMs=%llu timeoutMs=%llu",
+					                peerId.c_str(), ip.c_str(), (unsigned)port, matchId.c_str(),
+					                (unsigned long long)last, (unsigned long long)now2, (unsigned long long)_matchHeartbeatTimeoutMs);
 					clearMatch(ip, port, peerId, matchId, true);
 				}
 			}
-			// 4) ά5ࣨϸΪ10ԱʱӦֹͣ
+			// 4) ά5ࣨϸΪ10ԱʱӦֹͣÿβʱδ֡
 			for (int i = 0; i < 10 && _running && _maintenanceActive; ++i)
+			{
+				resendRetryFrames();
 				std::this_thread::sleep_for(std::chrono::milliseconds(500));
+			}
 		}
 	}
 
@@ -961,10 +1797,17 @@ namespace lanp2p
 	// ƥ״̬Ҫʱصϲж¼
 	void LanP2PNode::clearMatch(const std::string &ip, uint16_t tcpPort, const std::string &peerId,
 	                            const std::string &matchId, bool notify)
+	{
+		clearMatchByKey(ip + ":" + std::to_string(tcpPort) + ":" + peerId, ip, tcpPort, peerId, matchId, notify);
+	}
+
+	// ͬϣip:port:idɵ÷ַʱøõļƴ
+	void LanP2PNode::clearMatchByKey(const std::string &key, const std::string &ip, uint16_t tcpPort, const std::string &peerId,
+	                                 const std::string &matchId, bool notify)
 	{
 		{
 			std::lock_guard<std::mutex> lk(_peersMutex);
-			_matchesByKey.erase(ip + ":" + std::to_string(tcpPort) + ":" + peerId);
+			_matchesByKey.erase(key);
 			for (auto it = _peersByKey.begin(); it != _peersByKey.end(); )
 			{
 				const PeerInfo &p = it->second;
@@ -0,0 +1,380 @@
+#include "../include/MoveProvider.h"
+#include "../include/chess-game.h"
+#include "../include/chess-log.h"
+
+#define _WINSOCK_DEPRECATED_NO_WARNINGS
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "Ws2_32.lib")
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+// ---  ---
+
+bool ConsoleMoveProvider::getMove(const ChessBitBoard &board, char player, int coords[3])
+{
+	(void)board;
+	(void)player;
+	NativeGetChessPosition(coords);
+	return true;
+}
+
+// --- AIй ---
+
+void EngineMoveProvider::onGameStart(int boardSize, char myPlayer)
+{
+	(void)boardSize;
+	_myPlayer = myPlayer;
+	_ponderMove[0] = _ponderMove[1] = _ponderMove[2] = 0;
+	_ponderHit = false;
+	if (_engine)
+		_engine->clear();
+}
+
+void EngineMoveProvider::onGameEnd()
+{
+	if (_engine)
+		_engine->stopPonder();
+	_ponderHit = false;
+}
+
+void EngineMoveProvider::setTimeMs(int ms)
+{
+	if (ms > 0)
+		_timeMs = ms;
+}
+
+void EngineMoveProvider::setThreads(int threads)
+{
+	_threads = threads;
+}
+
+void EngineMoveProvider::setUseMcts(bool useMcts)
+{
+	_useMcts = useMcts;
+}
+
+void EngineMoveProvider::setPonder(bool enabled)
+{
+	_ponder = enabled;
+}
+
+void EngineMoveProvider::setBookPath(const std::string &path)
+{
+	_bookPath = path;
+}
+
+ChessEngineLimits EngineMoveProvider::limits() const
+{
+	ChessEngineLimits limits;
+	limits.timeMs = _timeMs.load();
+	limits.threads = _threads.load();
+	return limits;
+}
+
+bool EngineMoveProvider::getMove(const ChessBitBoard &board, char player, int coords[3])
+{
+	if (_useMcts.load())
+	{
+		if (!_mcts)
+			_mcts.reset(new ChessMcts());
+		const int N = board.boardSize;
+		_mctsBoard.resize((size_t)N * N * N);
+		BitBoardToChars(board, _mctsBoard.data());
+		ChessMctsLimits limits;
+		limits.timeMs = _timeMs.load();
+		limits.threads = _threads.load();
+		ChessMctsResult res;
+		if (_mcts->chooseMove(_mctsBoard.data(), N, player, limits, res))
+		{
+			coords[0] = res.move[0];
+			coords[1] = res.move[1];
+			coords[2] = res.move[2];
+			CHESS_LOG_INFO("[AI]  (%d, %d, %d) MCTS winRate=%g playouts=%llu treeNodes=%llu time=%llums", coords[0], coords[1], coords[2],
+			               res.winRate, (unsigned long long)res.playouts, (unsigned long long)res.treeNodes, (unsigned long long)res.elapsedMs);
+			for (size_t i = 0; i < res.threadPps.size() && res.threadPps.size() > 1; i++)
+				CHESS_LOG_INFO("[AI] ߳%u playouts=%llu pps=%llu", (unsigned)i, (unsigned long long)res.threadPlayouts[i], (unsigned long long)res.threadPps[i]);
+			return true;
+		}
+	}
+	else
+	{
+		if (!_engine)
+		{
+			_engine.reset(new ChessEngine());
+			if (!_bookPath.empty() && _book.open(_bookPath.c_str()))
+			{
+				_engine->setBook(&_book);
+				CHESS_LOG_INFO("[AI] Ѽؿֿ%s", _bookPath.c_str());
+			}
+		}
+		ChessEngineResult res;
+		bool ok;
+		if (_ponderHit)
+		{
+			// ̨ľǵǰ棬ʱȡ
+			_ponderHit = false;
+			ok = _engine->finishPonder(res);
+		}
+		else
+		{
+			ok = _engine->chooseMove(board, player, limits(), res);
+		}
+		_ponderMove[0] = res.ponderMove[0];
+		_ponderMove[1] = res.ponderMove[1];
+		_ponderMove[2] = res.ponderMove[2];
+		if (ok)
+		{
+			coords[0] = res.move[0];
+			coords[1] = res.move[1];
+			coords[2] = res.move[2];
+			CHESS_LOG_INFO("[AI]  (%d, %d, %d) depth=%d score=%d nodes=%llu time=%llums%s", coords[0], coords[1], coords[2], (int)res.depth,
+			               (int)res.score, (unsigned long long)res.nodes, (unsigned long long)res.elapsedMs, res.fromBook ? " (ֿ)" : "");
+			for (size_t i = 0; i < res.threadNps.size() && res.threadNps.size() > 1; i++)
+				CHESS_LOG_INFO("[AI] ߳%u nodes=%llu nps=%llu", (unsigned)i, (unsigned long long)res.threadNodes[i], (unsigned long long)res.threadNps[i]);
+			return true;
+		}
+	}
+	CHESS_LOG_INFO("[AI] ǰ޷ʹAIΪֶ");
+	NativeGetChessPosition(coords);
+	return true;
+}
+
+void EngineMoveProvider::onMove(const ChessBitBoard &board, const int coords[3], char player)
+{
+	if (player == _myPlayer)
+		startPondering(board);
+	else
+		onOpponentMove(coords);
+}
+
+void EngineMoveProvider::startPondering(const ChessBitBoard &board)
+{
+	_ponderHit = false;
+	if (!_engine || _useMcts.load() || !_ponder.load() || _ponderMove[0] == 0)
+		return;
+	// ̸߳ԤĶԷӦ֣Էʱûп˼
+	// һûߣòӡļ⣬һδʤ
+	ChessBitBoard predicted = board;
+	char opponentPlayer = (_myPlayer == '1') ? '2' : '1';
+	if (!BitBoardPlace(predicted, _ponderMove, opponentPlayer))
+		return;
+	const int plane = BitBoardPlane(opponentPlayer);
+	const int dir = predicted.lines.table
+	                ? LineCountersWinDirection(predicted.lines, place(_ponderMove[0], _ponderMove[1], _ponderMove[2], predicted.boardSize), plane)
+	                : BitBoardWinDirection(predicted, BitBoardIndex(predicted, _ponderMove[0], _ponderMove[1], _ponderMove[2]), plane);
+	if (dir >= 0)
+		return;
+	_engine->startPonder(predicted, _myPlayer, limits());
+	CHESS_LOG_INFO("[AI] ̨˼ԤԷ (%d, %d, %d)", _ponderMove[0], _ponderMove[1], _ponderMove[2]);
+}
+
+void EngineMoveProvider::onOpponentMove(const int move[3])
+{
+	if (!_engine || !_engine->isPondering())
+		return;
+	if (move[0] == _ponderMove[0] && move[1] == _ponderMove[1] && move[2] == _ponderMove[2])
+	{
+		_engine->ponderHit(_timeMs.load());
+		_ponderHit = true;
+		CHESS_LOG_INFO("[AI] ԤУ̨");
+	}
+	else
+	{
+		_engine->stopPonder();
+	}
+}
+
+// --- űļ ---
+
+ScriptedMoveProvider::ScriptedMoveProvider(const std::string &path)
+{
+	std::ifstream in(path.c_str());
+	if (!in)
+	{
+		CHESS_LOG_ERROR("ERROR opening move script %s", path.c_str());
+		return;
+	}
+	std::string line;
+	int lineNo = 0;
+	while (std::getline(in, line))
+	{
+		lineNo++;
+		std::replace(line.begin(), line.end(), ',', ' ');
+		std::istringstream iss(line);
+		int x, y, z;
+		if (!(iss >> x))
+			continue;// л#ע
+		if (!(iss >> y >> z))
+		{
+			CHESS_LOG_ERROR("ERROR move script %s line %d: expected x y z", path.c_str(), lineNo);
+			continue;
+		}
+		_moves.push_back(x);
+		_moves.push_back(y);
+		_moves.push_back(z);
+	}
+}
+
+void ScriptedMoveProvider::onGameStart(int boardSize, char myPlayer)
+{
+	(void)boardSize;
+	(void)myPlayer;
+	_next = 0;
+}
+
+bool ScriptedMoveProvider::getMove(const ChessBitBoard &board, char player, int coords[3])
+{
+	(void)board;
+	(void)player;
+	if (_next + 3 > _moves.size())
+		return false;
+	coords[0] = _moves[_next];
+	coords[1] = _moves[_next + 1];
+	coords[2] = _moves[_next + 2];
+	_next += 3;
+	return true;
+}
+
+// --- Զ̿ ---
+
+RemoteMoveProvider::RemoteMoveProvider(const std::string &host, uint16_t port, int timeoutMs)
+	: _host(host), _port(port), _timeoutMs(timeoutMs)
+{
+	WSADATA wsa;
+	WSAStartup(MAKEWORD(2, 2), &wsa);
+}
+
+RemoteMoveProvider::~RemoteMoveProvider()
+{
+	disconnect();
+	WSACleanup();
+}
+
+bool RemoteMoveProvider::connect()
+{
+	if (isConnected())
+		return true;
+	uintptr_t s = (uintptr_t)socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if ((SOCKET)s == INVALID_SOCKET)
+		return false;
+	sockaddr_in addr{};
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(_port);
+	addr.sin_addr.s_addr = inet_addr(_host.c_str());
+	if (::connect(static_cast<SOCKET>(s), (sockaddr *)&addr, sizeof(addr)) != 0)
+	{
+		closesocket(static_cast<SOCKET>(s));
+		CHESS_LOG_ERROR("ERROR connecting to move controller %s:%d", _host.c_str(), (int)_port);
+		return false;
+	}
+	// ÿֻһУصNagle40msĺϲӳ
+	BOOL noDelay = TRUE;
+	setsockopt(static_cast<SOCKET>(s), IPPROTO_TCP, TCP_NODELAY, (const char *)&noDelay, sizeof(noDelay));
+	if (_timeoutMs > 0)
+	{
+		DWORD tv = (DWORD)_timeoutMs;
+		setsockopt(static_cast<SOCKET>(s), SOL_SOCKET, SO_RCVTIMEO, (const char *)&tv, sizeof(tv));
+	}
+	_sock = s;
+	_recvBuf.clear();
+	return true;
+}
+
+void RemoteMoveProvider::disconnect()
+{
+	if (!isConnected())
+		return;
+	closesocket(static_cast<SOCKET>(_sock));
+	_sock = ~(uintptr_t)0;
+	_recvBuf.clear();
+}
+
+bool RemoteMoveProvider::sendLine(const std::string &line)
+{
+	if (!isConnected())
+		return false;
+	std::string data = line + "\n";
+	int off = 0;
+	while (off < (int)data.size())
+	{
+		int r = send(static_cast<SOCKET>(_sock), data.data() + off, (int)data.size() - off, 0);
+		if (r <= 0)
+		{
+			disconnect();
+			return false;
+		}
+		off += r;
+	}
+	return true;
+}
+
+bool RemoteMoveProvider::readLine(std::string &line)
+{
+	while (isConnected())
+	{
+		size_t eol = _recvBuf.find('\n');
+		if (eol != std::string::npos)
+		{
+			line.assign(_recvBuf, 0, eol);
+			_recvBuf.erase(0, eol + 1);
+			if (!line.empty() && line.back() == '\r')
+				line.pop_back();
+			return true;
+		}
+		// һвӦȣֹԶ˲ʱ
+		if (_recvBuf.size() > 4096)
+			break;
+		char buf[512];
+		int r = recv(static_cast<SOCKET>(_sock), buf, sizeof(buf), 0);
+		if (r <= 0)
+			break;
+		_recvBuf.append(buf, (size_t)r);
+	}
+	disconnect();
+	return false;
+}
+
+void RemoteMoveProvider::onGameStart(int boardSize, char myPlayer)
+{
+	if (!connect())
+		return;
+	std::ostringstream oss;
+	oss << "START " << boardSize << " " << myPlayer;
+	sendLine(oss.str());
+}
+
+bool RemoteMoveProvider::getMove(const ChessBitBoard &board, char player, int coords[3])
+{
+	(void)board;
+	(void)player;
+	std::string line;
+	if (!sendLine("GO") || !readLine(line))
+	{
+		CHESS_LOG_WARN("[Remote] ƶ%s:%uѶϿ", _host.c_str(), (unsigned)_port);
+		return false;
+	}
+	std::replace(line.begin(), line.end(), ',', ' ');
+	std::istringstream iss(line);
+	if (!(iss >> coords[0] >> coords[1] >> coords[2]))
+	{
+		CHESS_LOG_WARN("[Remote] ޷ƶ˵Ļظ: %s", line.c_str());
+		return false;
+	}
+	return true;
+}
+
+void RemoteMoveProvider::onMove(const ChessBitBoard &board, const int coords[3], char player)
+{
+	(void)board;
+	std::ostringstream oss;
+	oss << "MOVE " << player << " " << coords[0] << " " << coords[1] << " " << coords[2];
+	sendLine(oss.str());
+}
+
+void RemoteMoveProvider::onGameEnd()
+{
+	sendLine("END");
+}
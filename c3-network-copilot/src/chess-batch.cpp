@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include "../include/chess-batch.h"
+#include "../include/chess-game.h"
+using namespace std;
+
+//ÿ߳ٷֵСͲֵÿ߳
+static const size_t BatchMinPerThread = 1024;
+
+//ƫk-4ĳһϵĿ÷Χx+(k-4)*dx[1, N]
+static inline void ClampAxis(int v, int dv, int N, int &lo, int &hi)
+{
+	if (dv > 0)
+	{
+		lo = max(lo, 1 - v);
+		hi = min(hi, N - v);
+	}
+	else if (dv < 0)
+	{
+		lo = max(lo, v - N);
+		hi = min(hi, v - 1);
+	}
+}
+
+//ӵжϣӵ㵱playerӣCheckWinͬ
+//ÿڵƫƷΧڲѭжϱ߽磬ȽϽֱλƴɴ
+static int BatchWinDirection(const ChessBatchMove &m)
+{
+	const int N = m.BoardSize;
+	const int x = m.input[0], y = m.input[1], z = m.input[2];
+	const char *board = m.ChessBoard;
+	const int center = place(x, y, z, N);
+	uint32_t windows[ChessDirectionCount];
+	for (int d = 0; d < ChessDirectionCount; d++)
+	{
+		const int dx = ChessDirections[d][0], dy = ChessDirections[d][1], dz = ChessDirections[d][2];
+		const int step = dx + dy * N + dz * N * N;
+		int lo = -4, hi = 4;
+		ClampAxis(x, dx, N, lo, hi);
+		ClampAxis(y, dy, N, lo, hi);
+		ClampAxis(z, dz, N, lo, hi);
+		uint32_t w = 1u << 4;
+		const char *p = board + center + lo * step;
+		for (int k = lo; k <= hi; k++, p += step)
+			w |= (uint32_t)(*p == m.player) << (k + 4);
+		windows[d] = w;
+	}
+	return FindFiveDirection(windows);
+}
+
+static void CheckMovesRange(const ChessBatchMove *moves, size_t begin, size_t end, ChessBatchResult *results)
+{
+	for (size_t i = begin; i < end; i++)
+	{
+		const ChessBatchMove &m = moves[i];
+		ChessBatchResult &r = results[i];
+		r.winDirection = -1;
+		const int N = m.BoardSize;
+		if (m.player != '1' && m.player != '2')
+		{
+			r.status = ChessBatchBadPlayer;
+			continue;
+		}
+		if (m.input[0] < 1 || m.input[0] > N || m.input[1] < 1 || m.input[1] > N || m.input[2] < 1 || m.input[2] > N)
+		{
+			r.status = ChessBatchOutOfRange;
+			continue;
+		}
+		if (m.ChessBoard[place(m.input[0], m.input[1], m.input[2], N)] != 0)
+		{
+			r.status = ChessBatchOccupied;
+			continue;
+		}
+		r.status = ChessBatchLegal;
+		r.winDirection = (int8_t)BatchWinDirection(m);
+	}
+}
+
+void CheckMovesBatch(const ChessBatchMove *moves, size_t count, ChessBatchResult *results, int threads)
+{
+	size_t threadCount = threads > 0 ? (size_t)threads : max(1u, thread::hardware_concurrency());
+	threadCount = min(threadCount, max((size_t)1, count / BatchMinPerThread));
+	if (threadCount <= 1)
+	{
+		CheckMovesRange(moves, 0, count, results);
+		return;
+	}
+	// п飺ÿ߳дཻһresults
+	vector<thread> workers;
+	const size_t chunk = (count + threadCount - 1) / threadCount;
+	for (size_t t = 1; t < threadCount; t++)
+	{
+		size_t begin = t * chunk, end = min(count, begin + chunk);
+		if (begin < end)
+			workers.push_back(thread(CheckMovesRange, moves, begin, end, results));
+	}
+	CheckMovesRange(moves, 0, min(count, chunk), results);
+	for (size_t t = 0; t < workers.size(); t++)
+		workers[t].join();
+}
@@ -0,0 +1,191 @@
+#include <algorithm>
+#include <cstdio>
+#include "../include/chess-bitboard.h"
+#include "../include/chess-log.h"
+//λ̵Ĳ꣺index = origin + (x-1) + (y-1)*pitch + (z-1)*layerpitch = BoardSize+4origin = 5*layer
+//xԽ磨-4..-1BoardSize..BoardSize+3䵽ĩβ4հףyͬ䵽հУz䵽ǰ󲹵Ŀհײ
+using namespace std;
+
+
+//λ
+int64_t BitBoardIndex(const ChessBitBoard &board, int x, int y, int z)
+{
+	return board.origin + (x - 1) + (int64_t)(y - 1) * board.pitch + (int64_t)(z - 1) * board.layer;
+}
+
+bool OnlineInitBitBoard(ChessBitBoard *pBoard, int BoardSize)
+{
+	if (BoardSize < 1)
+	{
+		CHESS_LOG_ERROR("ERROR allocating online bit board!");
+		return false;
+	}
+	pBoard->boardSize = BoardSize;
+	pBoard->pitch = BoardSize + 4;
+	pBoard->layer = (int64_t)pBoard->pitch * pBoard->pitch;
+	pBoard->origin = 5 * pBoard->layer;
+	for (int d = 0; d < ChessDirectionCount; d++)
+	{
+		pBoard->strides[d] = ChessDirections[d][0] + (int64_t)ChessDirections[d][1] * pBoard->pitch
+		                     + ChessDirections[d][2] * pBoard->layer;
+	}
+	// һ֣֤λʱȡw+1Խ
+	size_t bits = (size_t)(pBoard->layer * (BoardSize + 10));
+	size_t words = bits / 64 + 2;
+	for (int p = 0; p < 2; p++)
+	{
+		pBoard->planes[p].assign(words, 0);
+	}
+	// ̲߱ʤ˻λڷʽ
+	InitLineCounters(&pBoard->lines, BoardSize);
+	return true;
+}
+
+void FreeBitBoard(ChessBitBoard *pBoard)
+{
+	for (int p = 0; p < 2; p++)
+	{
+		vector<uint64_t>().swap(pBoard->planes[p]);
+	}
+	FreeLineCounters(&pBoard->lines);
+	pBoard->boardSize = 0;
+}
+
+//ӵѷڴ棬Ծʱ
+void ClearBitBoard(ChessBitBoard &board)
+{
+	for (int p = 0; p < 2; p++)
+		fill(board.planes[p].begin(), board.planes[p].end(), 0ull);
+	if (board.lines.table)
+		InitLineCounters(&board.lines, board.boardSize);
+}
+
+//ȡĳλϵӣ'1''2'λ0char̵ȡֵһ£
+char BitBoardAt(const ChessBitBoard &board, int x, int y, int z)
+{
+	int64_t index = BitBoardIndex(board, x, y, z);
+	if (BitBoardTest(board.planes[0].data(), index))
+		return '1';
+	if (BitBoardTest(board.planes[1].data(), index))
+		return '2';
+	return 0;
+}
+
+//ΪOnlineInitChessBoarḍֵַ0/'1'/'2'char*̹ģʹ
+void BitBoardToChars(const ChessBitBoard &board, char *ChessBoard)
+{
+	const int N = board.boardSize;
+	for (int z = 1; z <= N; z++)
+		for (int y = 1; y <= N; y++)
+			for (int x = 1; x <= N; x++)
+				ChessBoard[place(x, y, z, N)] = BitBoardAt(board, x, y, z);
+}
+
+//UpdateBoardStateͬĺϷԼֻдλƽ
+bool UpdateBitBoardState(ChessBitBoard &board, int input[], char player)
+{
+	int BoardSize = board.boardSize;
+	if (input[0] < 1 || input[0] > BoardSize || input[1] < 1 || input[1] > BoardSize || input[2] < 1
+	        || input[2] > BoardSize)
+	{
+		CHESS_LOG_INFO("INVALID_MOVE: Position is out of the board range.");
+		return false;
+	}
+
+	int64_t index = BitBoardIndex(board, input[0], input[1], input[2]);
+	if (BitBoardTest(board.planes[0].data(), index) || BitBoardTest(board.planes[1].data(), index))
+	{
+		CHESS_LOG_INFO("INVALID_MOVE: A chess piece already exists at this position.");
+		return false;
+	}
+
+	board.planes[BitBoardPlane(player)][index >> 6] |= 1ull << (index & 63);
+	if (board.lines.table)
+		LineCountersPlace(board.lines, place(input[0], input[1], input[2], BoardSize), BitBoardPlane(player));
+	CHESS_LOG_DEBUG("MOVE_ACCEPTED: Board updated. Player %c placed a piece at (%d, %d, %d).", player, input[0], input[1], input[2]);
+	return true;
+}
+
+//ӡӣԽӷfalse
+bool BitBoardPlace(ChessBitBoard &board, const int input[], char player)
+{
+	const int BoardSize = board.boardSize;
+	if (input[0] < 1 || input[0] > BoardSize || input[1] < 1 || input[1] > BoardSize || input[2] < 1
+	        || input[2] > BoardSize)
+		return false;
+	int64_t index = BitBoardIndex(board, input[0], input[1], input[2]);
+	if (BitBoardTest(board.planes[0].data(), index) || BitBoardTest(board.planes[1].data(), index))
+		return false;
+	board.planes[BitBoardPlane(player)][index >> 6] |= 1ull << (index & 63);
+	if (board.lines.table)
+		LineCountersPlace(board.lines, place(input[0], input[1], input[2], BoardSize), BitBoardPlane(player));
+	return true;
+}
+
+//CheckWinͬԼӡ1򷵻0
+//߼ʱֻ鿴ӵߣȡ13λ
+int CheckWinBitBoard(const ChessBitBoard &board, int input[], char player)
+{
+	int dir;
+	if (board.lines.table)
+		dir = LineCountersWinDirection(board.lines, place(input[0], input[1], input[2], board.boardSize), BitBoardPlane(player));
+	else
+		dir = BitBoardWinDirection(board, BitBoardIndex(board, input[0], input[1], input[2]), BitBoardPlane(player));
+	if (dir >= 0)
+	{
+		CHESS_LOG_INFO("The player%c wins! In the %s direction", player, ChessDirectionNames[dir]);
+		return 1;
+	}
+	return 0;
+}
+
+//13ȡindexΪĵ9λڣвĿհףҪκα߽ж
+int BitBoardWinDirection(const ChessBitBoard &board, int64_t index, int plane)
+{
+	const uint64_t *bits = board.planes[plane].data();
+	uint32_t windows[ChessDirectionCount];
+	for (int d = 0; d < ChessDirectionCount; d++)
+	{
+		int64_t stride = board.strides[d];
+		int64_t p = index - 4 * stride;
+		uint32_t w = 0;
+		for (int k = 0; k < 9; k++, p += stride)
+			w |= (uint32_t)((bits[p >> 6] >> (p & 63)) & 1ull) << k;
+		windows[d] = w;
+	}
+	return FindFiveDirection(windows);
+}
+
+//ȡλƽshiftλĵw
+static inline uint64_t ShiftedWord(const uint64_t *bits, size_t words, size_t w, int64_t shift)
+{
+	size_t q = w + (size_t)(shift >> 6);
+	int r = (int)(shift & 63);
+	uint64_t lo = q < words ? bits[q] : 0;
+	if (r == 0)
+		return lo;
+	uint64_t hi = q + 1 < words ? bits[q + 1] : 0;
+	return (lo >> r) | (hi << (64 - r));
+}
+
+//⣺ÿ P & P>>s & P>>2s & P>>3s & P>>4sһδ64
+//Ŀհױ֤λѲͬ/Ӵһ
+bool BitBoardHasFive(const ChessBitBoard &board, char player)
+{
+	const vector<uint64_t> &plane = board.planes[BitBoardPlane(player)];
+	const uint64_t *bits = plane.data();
+	size_t words = plane.size();
+	for (int d = 0; d < ChessDirectionCount; d++)
+	{
+		int64_t s = board.strides[d];
+		uint64_t any = 0;
+		for (size_t w = 0; w < words; w++)
+		{
+			any |= bits[w] & ShiftedWord(bits, words, w, s) & ShiftedWord(bits, words, w, 2 * s)
+			       & ShiftedWord(bits, words, w, 3 * s) & ShiftedWord(bits, words, w, 4 * s);
+		}
+		if (any)
+			return true;
+	}
+	return false;
+}
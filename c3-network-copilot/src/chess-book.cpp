@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include "../include/chess-book.h"
+#include "../include/chess-log.h"
+using namespace std;
+
+//Ӽλ̽ô
+static const uint64_t BookProbeWindow = 8;
+
+//淶ϣΪ0ֻп̣һ̶ķ0ֵ0ղ
+static inline uint64_t BookKey(uint64_t key)
+{
+	return key ? key : 0x9E3779B97F4A7C15ull;
+}
+
+//ĺ֣move|score|depth|flags  games|points2λChessBookEntryڴ沼һ
+static inline uint64_t BookData(const ChessBookEntry &e)
+{
+	return (uint64_t)(uint32_t)e.move | (uint64_t)(uint16_t)e.score << 32 | (uint64_t)e.depth << 48 | (uint64_t)e.flags << 56;
+}
+
+static inline uint64_t BookStats(const ChessBookEntry &e)
+{
+	return (uint64_t)e.games | (uint64_t)e.points2 << 32;
+}
+
+static inline void BookDecode(uint64_t key, uint64_t data, uint64_t stats, ChessBookEntry &e)
+{
+	e.key = key;
+	e.move = (int32_t)(uint32_t)data;
+	e.score = (int16_t)(uint16_t)(data >> 32);
+	e.depth = (uint8_t)(data >> 48);
+	e.flags = (uint8_t)(data >> 56);
+	e.games = (uint32_t)stats;
+	e.points2 = (uint32_t)(stats >> 32);
+}
+
+bool CreateChessBook(const char *path, int BoardSize, uint64_t slotCount)
+{
+	uint64_t slots = 1;
+	while (slots < slotCount)
+		slots *= 2;
+	FILE *f = fopen(path, "wb");
+	if (!f)
+	{
+		CHESS_LOG_ERROR("ERROR creating book file %s", path);
+		return false;
+	}
+	ChessBookFileHeader h;
+	memset(&h, 0, sizeof(h));
+	h.magic = ChessBookMagic;
+	h.version = ChessBookVersion;
+	h.entryBytes = (uint16_t)sizeof(ChessBookEntry);
+	h.boardSize = (uint32_t)BoardSize;
+	h.slotCount = slots;
+	bool ok = fwrite(&h, sizeof(h), 1, f) == 1;
+	// ֿд㣬һη
+	static const ChessBookEntry zeros[1024] = {};
+	for (uint64_t done = 0; ok && done < slots; done += 1024)
+	{
+		size_t n = (size_t)min<uint64_t>(1024, slots - done);
+		ok = fwrite(zeros, sizeof(ChessBookEntry), n, f) == n;
+	}
+	ok = fclose(f) == 0 && ok;
+	if (!ok)
+		CHESS_LOG_ERROR("ERROR writing book file %s", path);
+	return ok;
+}
+
+bool ChessBook::open(const char *path, bool writable)
+{
+	close();
+	if (!_file.open(path, writable, ChessMapRandom))
+		return false;
+	const ChessBookFileHeader *h = (const ChessBookFileHeader *)_file.data();
+	if (h == nullptr || _file.size() < sizeof(*h) || h->magic != ChessBookMagic || h->version != ChessBookVersion ||
+	        h->entryBytes != sizeof(ChessBookEntry) ||
+	        h->slotCount == 0 || (h->slotCount & (h->slotCount - 1)) != 0 ||
+	        _file.size() < sizeof(*h) + h->slotCount * sizeof(ChessBookEntry))
+	{
+		CHESS_LOG_ERROR("ERROR invalid book file %s", path);
+		close();
+		return false;
+	}
+	_entries = (Slot *)(_file.data() + sizeof(*h));
+	_mask = h->slotCount - 1;
+	_boardSize = (int)h->boardSize;
+	return true;
+}
+
+bool ChessBook::probe(uint64_t key, ChessBookEntry &entry) const
+{
+	if (!_entries)
+		return false;
+	key = BookKey(key);
+	for (uint64_t i = 0; i < BookProbeWindow; i++)
+	{
+		const Slot &e = _entries[(key + i) & _mask];
+		const uint64_t data = e.data.load(memory_order_relaxed);
+		const uint64_t stats = e.stats.load(memory_order_relaxed);
+		const uint64_t check = e.check.load(memory_order_relaxed);
+		if ((check ^ data ^ stats) == key)
+		{
+			BookDecode(key, data, stats, entry);
+			return true;
+		}
+		if (check == 0 && data == 0 && stats == 0)
+			return false;
+	}
+	return false;
+}
+
+//ҵkeyڵĲ۲뵽entryûȡڵĿղۣʱ滻Ϣ٣ȡСһ
+//ֻڳдʱã˶Ĳ۲ᱻд
+ChessBook::Slot *ChessBook::findSlot(uint64_t key, int depth, ChessBookEntry &entry)
+{
+	if (!_entries || !_file.writable())
+		return nullptr;
+	Slot *victim = nullptr;
+	ChessBookEntry v = {};
+	for (uint64_t i = 0; i < BookProbeWindow; i++)
+	{
+		Slot &e = _entries[(key + i) & _mask];
+		const uint64_t data = e.data.load(memory_order_relaxed);
+		const uint64_t stats = e.stats.load(memory_order_relaxed);
+		const uint64_t check = e.check.load(memory_order_relaxed);
+		ChessBookEntry cur;
+		BookDecode(check ^ data ^ stats, data, stats, cur);
+		if (cur.key == key)
+		{
+			entry = cur;
+			return &e;
+		}
+		if (check == 0 && data == 0 && stats == 0)
+		{
+			victim = &e;
+			v = cur;
+			v.key = 0;
+			break;
+		}
+		if (!victim || cur.depth < v.depth || (cur.depth == v.depth && cur.games < v.games))
+		{
+			victim = &e;
+			v = cur;
+		}
+	}
+	if (v.key != 0 && v.depth > depth)
+		return nullptr;
+	entry.key = key;
+	entry.move = -1;
+	entry.score = 0;
+	entry.depth = 0;
+	entry.flags = 0;
+	entry.games = 0;
+	entry.points2 = 0;
+	return victim;
+}
+
+//дһд֣дУ֣ȡһ֮ǰУ鶼ͨ
+void ChessBook::write(Slot &slot, const ChessBookEntry &entry)
+{
+	const uint64_t data = BookData(entry);
+	const uint64_t stats = BookStats(entry);
+	slot.data.store(data, memory_order_relaxed);
+	slot.stats.store(stats, memory_order_relaxed);
+	slot.check.store(entry.key ^ data ^ stats, memory_order_release);
+}
+
+bool ChessBook::store(uint64_t key, int move, int score, int depth, int flags)
+{
+	key = BookKey(key);
+	lock_guard<mutex> lk(_writeMutex);
+	ChessBookEntry e;
+	Slot *slot = findSlot(key, depth, e);
+	if (!slot || e.depth > depth || ((e.flags & ChessBookSolved) && !(flags & ChessBookSolved)))
+		return false;
+	e.move = move;
+	e.score = (int16_t)max(-32767, min(32767, score));
+	e.depth = (uint8_t)min(depth, 255);
+	e.flags = (uint8_t)flags;
+	write(*slot, e);
+	return true;
+}
+
+bool ChessBook::addResult(uint64_t key, int points2)
+{
+	key = BookKey(key);
+	lock_guard<mutex> lk(_writeMutex);
+	ChessBookEntry e;
+	Slot *slot = findSlot(key, 0, e);
+	if (!slot)
+		return false;
+	e.games++;
+	e.points2 += (uint32_t)points2;
+	write(*slot, e);
+	return true;
+}
@@ -0,0 +1,101 @@
+#include "../include/chess-candidates.h"
+#include "../include/chess-log.h"
+using namespace std;
+
+static inline void CandidatesAdd(ChessCandidates &c, int cell)
+{
+	c.slot[cell] = (int32_t)c.cells.size();
+	c.cells.push_back(cell);
+}
+
+//ĩβԪػɾλ
+static inline void CandidatesErase(ChessCandidates &c, int cell)
+{
+	int32_t i = c.slot[cell];
+	int32_t last = c.cells.back();
+	c.cells[i] = last;
+	c.slot[last] = i;
+	c.cells.pop_back();
+	c.slot[cell] = -1;
+}
+
+bool InitCandidates(ChessCandidates *pCandidates, int BoardSize, int radius)
+{
+	if (BoardSize < 1 || radius < 1 || radius > 4)
+	{
+		CHESS_LOG_ERROR("ERROR allocating candidate set!");
+		return false;
+	}
+	size_t cells = (size_t)BoardSize * BoardSize * BoardSize;
+	pCandidates->boardSize = BoardSize;
+	pCandidates->radius = radius;
+	pCandidates->cells.clear();
+	pCandidates->cells.reserve(cells);
+	pCandidates->slot.assign(cells, -1);
+	pCandidates->coverage.assign(cells, 0);
+	pCandidates->occupied.assign(cells, 0);
+	pCandidates->offsets.clear();
+	for (int dz = -radius; dz <= radius; dz++)
+	{
+		for (int dy = -radius; dy <= radius; dy++)
+		{
+			for (int dx = -radius; dx <= radius; dx++)
+			{
+				if (dx == 0 && dy == 0 && dz == 0)
+					continue;
+				pCandidates->offsets.push_back((int8_t)dx);
+				pCandidates->offsets.push_back((int8_t)dy);
+				pCandidates->offsets.push_back((int8_t)dz);
+			}
+		}
+	}
+	return true;
+}
+
+void FreeCandidates(ChessCandidates *pCandidates)
+{
+	vector<int32_t>().swap(pCandidates->cells);
+	vector<int32_t>().swap(pCandidates->slot);
+	vector<uint16_t>().swap(pCandidates->coverage);
+	vector<uint8_t>().swap(pCandidates->occupied);
+	vector<int8_t>().swap(pCandidates->offsets);
+	pCandidates->boardSize = 0;
+}
+
+void CandidatesPlace(ChessCandidates &candidates, int cell)
+{
+	const int N = candidates.boardSize;
+	const int x = cell % N, y = cell / N % N, z = cell / (N * N);
+	if (candidates.slot[cell] >= 0)
+		CandidatesErase(candidates, cell);
+	candidates.occupied[cell] = 1;
+	const int8_t *o = candidates.offsets.data();
+	for (size_t k = 0; k < candidates.offsets.size(); k += 3)
+	{
+		int nx = x + o[k], ny = y + o[k + 1], nz = z + o[k + 2];
+		if (nx < 0 || nx >= N || ny < 0 || ny >= N || nz < 0 || nz >= N)
+			continue;
+		int n = nx + ny * N + nz * N * N;
+		if (candidates.coverage[n]++ == 0 && !candidates.occupied[n])
+			CandidatesAdd(candidates, n);
+	}
+}
+
+void CandidatesRemove(ChessCandidates &candidates, int cell)
+{
+	const int N = candidates.boardSize;
+	const int x = cell % N, y = cell / N % N, z = cell / (N * N);
+	const int8_t *o = candidates.offsets.data();
+	for (size_t k = candidates.offsets.size(); k > 0; k -= 3)
+	{
+		int nx = x + o[k - 3], ny = y + o[k - 2], nz = z + o[k - 1];
+		if (nx < 0 || nx >= N || ny < 0 || ny >= N || nz < 0 || nz >= N)
+			continue;
+		int n = nx + ny * N + nz * N * N;
+		if (--candidates.coverage[n] == 0 && candidates.slot[n] >= 0)
+			CandidatesErase(candidates, n);
+	}
+	candidates.occupied[cell] = 0;
+	if (candidates.coverage[cell] > 0)
+		CandidatesAdd(candidates, cell);
+}
@@ -0,0 +1,521 @@
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include "../include/chess-engine.h"
+#include "../include/chess-position.h"
+#include "../include/chess-symmetry.h"
+#include "../include/chess-threat.h"
+using namespace std;
+
+//ϼkӵļֵ
+static const int LineWeights[6] = { 0, 1, 12, 120, 1500, 0 };
+//ѡڼkӻϵĽֵڶԷkӻϵķؼֵk=4/壩
+static const int AttackWeights[5] = { 1, 8, 64, 1024, 1 << 20 };
+static const int DefendWeights[5] = { 0, 6, 48, 768, 1 << 18 };
+
+//ǰļ飺ǸڵĺѡضϿ©ϳĳʤ
+static bool FindVcf(const ChessBitBoard &board, char player, uint64_t maxNodes, ChessThreatResult &vcf)
+{
+	vector<char> chars((size_t)board.boardSize * board.boardSize * board.boardSize);
+	BitBoardToChars(board, chars.data());
+	ChessThreatLimits limits;
+	limits.maxNodes = maxNodes;
+	return SolveThreatSpace(chars.data(), board.boardSize, player, limits, vcf) && vcf.status == ChessThreatStatus::Win;
+}
+
+//û߽
+enum
+{
+	BoundUpper = 1,
+	BoundLower = 2,
+	BoundExact = 3
+};
+
+//̵߳״̬渱ջChessPositionõı
+struct ChessEngine::SearchState
+{
+	ChessPosition pos;                       //ѡȡΧһڵĿλ
+	int32_t killers[MaxPly][2];
+	vector<int32_t> moveLists[MaxPly];
+	vector<pair<int64_t, int32_t>> scored;  //ѡõʱ
+	vector<int32_t> history;                 //history[cell*2+plane]
+	int rootBestMove{ -1 };
+	uint64_t nodes{ 0 };
+};
+
+ChessEngine::ChessEngine(size_t ttMegabytes)
+{
+	size_t entries = 1;
+	while (entries * 2 * sizeof(TTEntry) <= ttMegabytes * 1024 * 1024)
+		entries *= 2;
+	_tt.reset(new TTEntry[entries]);
+	_ttMask = entries - 1;
+}
+
+ChessEngine::~ChessEngine()
+{
+	stopPonder();
+}
+
+void ChessEngine::stop()
+{
+	_stop = true;
+}
+
+void ChessEngine::clear()
+{
+	stopPonder();
+	clearTT();
+}
+
+void ChessEngine::setBook(ChessBook *book)
+{
+	_book = book;
+}
+
+void ChessEngine::clearTT()
+{
+	for (uint64_t i = 0; i <= _ttMask; i++)
+	{
+		_tt[i].check.store(0, memory_order_relaxed);
+		_tt[i].data.store(0, memory_order_relaxed);
+	}
+}
+
+bool ChessEngine::chooseMove(const ChessBitBoard &board, char player, const ChessEngineLimits &limits,
+                             ChessEngineResult &result)
+{
+	stopPonder();
+	armLimits(limits);
+	return runSearch(board, player, limits, result);
+}
+
+void ChessEngine::startPonder(const ChessBitBoard &board, char player, const ChessEngineLimits &limits)
+{
+	stopPonder();
+	ChessEngineLimits ponderLimits = limits;
+	ponderLimits.timeMs = 0;
+	ponderLimits.maxNodes = 0;
+	// ߳ǰã֮stop/ponderHitᱻ̵߳ĳʼ
+	armLimits(ponderLimits);
+	_ponderBoard = board;
+	_ponderOk = false;
+	_ponderThread = thread([this, player, ponderLimits]()
+	{
+		_ponderOk = runSearch(_ponderBoard, player, ponderLimits, _ponderResult);
+	});
+}
+
+void ChessEngine::ponderHit(int timeMs)
+{
+	if (_ponderThread.joinable())
+		setDeadline(timeMs);
+}
+
+bool ChessEngine::finishPonder(ChessEngineResult &result)
+{
+	if (!_ponderThread.joinable())
+		return false;
+	_ponderThread.join();
+	result = _ponderResult;
+	return _ponderOk;
+}
+
+void ChessEngine::stopPonder()
+{
+	if (!_ponderThread.joinable())
+		return;
+	_stop = true;
+	_ponderThread.join();
+}
+
+void ChessEngine::armLimits(const ChessEngineLimits &limits)
+{
+	_stop = false;
+	_totalNodes = 0;
+	_maxNodes = limits.maxNodes;
+	setDeadline(limits.timeMs);
+}
+
+void ChessEngine::setDeadline(int timeMs)
+{
+	const int64_t now = (int64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+	_deadlineNs.store(timeMs > 0 ? now + (int64_t)timeMs * 1000000 : INT64_MAX, memory_order_release);
+}
+
+//chooseMovę˼ọ̃ǰarmLimitsֹͣ
+bool ChessEngine::runSearch(const ChessBitBoard &board, char player, const ChessEngineLimits &limits,
+                            ChessEngineResult &result)
+{
+	const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	result = ChessEngineResult();
+	const int N = board.boardSize;
+	if (board.lines.table == nullptr)
+		return false;
+
+	// Ƹ
+	SearchState s;
+	vector<char> chars((size_t)N * N * N);
+	BitBoardToChars(board, chars.data());
+	const int track = PositionTrackSymmetry | (limits.patternEval ? PositionTrackPatterns : 0);
+	if (!InitPosition(&s.pos, N, 1, track) || !PositionLoad(s.pos, chars.data(), BitBoardPlane(player)))
+		return false;
+	memset(s.killers, -1, sizeof(s.killers));
+	const int stoneCount = (int)s.pos.moves.size();
+	if (stoneCount >= s.pos.cells)
+		return false;
+
+	if (_boardSize != N)
+	{
+		_boardSize = N;
+		clearTT();
+	}
+	s.history.assign((size_t)s.pos.cells * 2, 0);
+	_maxCandidates = max(1, limits.maxCandidates);
+
+	int threadCount = limits.threads;
+	if (threadCount <= 0)
+		threadCount = max(1, (int)thread::hardware_concurrency());
+
+	vector<uint64_t> nodes(threadCount, 0);
+	ChessThreatResult vcf;
+	if (stoneCount == 0)
+	{
+		// ֱԪ
+		result.move[0] = result.move[1] = result.move[2] = (N + 1) / 2;
+	}
+	else if (probeBook(s, limits.bookMinDepth, limits.maxDepth, result))
+	{
+		result.fromBook = true;
+	}
+	else if (limits.vcfNodes > 0 && FindVcf(board, player, limits.vcfNodes, vcf))
+	{
+		// ֤ʤֱ߳еĵһ
+		for (int i = 0; i < 3; i++)
+			result.move[i] = vcf.move[i];
+		result.depth = (int)vcf.sequence.size();
+		result.score = WinScore - result.depth;
+		nodes[0] = vcf.nodes;
+		storeBook(s, result, limits.bookMinDepth, true);
+	}
+	else
+	{
+		// ̸߳һݾ渱߳ڵǰ߳
+		vector<SearchState> helpers(threadCount - 1, s);
+		vector<thread> workers;
+		for (int i = 1; i < threadCount; i++)
+			workers.push_back(thread(&ChessEngine::searchThread, this, ref(helpers[i - 1]), i, limits.maxDepth,
+			                         (ChessEngineResult *)nullptr));
+		searchThread(s, 0, limits.maxDepth, &result);
+		_stop = true;
+		for (size_t i = 0; i < workers.size(); i++)
+			workers[i].join();
+		nodes[0] = s.nodes;
+		for (int i = 1; i < threadCount; i++)
+			nodes[i] = helpers[i - 1].nodes;
+		storeBook(s, result, limits.bookMinDepth, result.score >= WinScore - MaxPly || result.score <= -WinScore + MaxPly);
+		fillPonderMove(s, result);
+	}
+
+	result.elapsedMs = (uint64_t)chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+	result.nodes = 0;
+	result.threadNodes = nodes;
+	result.threadNps.resize(threadCount);
+	for (int i = 0; i < threadCount; i++)
+	{
+		result.nodes += nodes[i];
+		result.threadNps[i] = result.elapsedMs > 0 ? nodes[i] * 1000 / result.elapsedMs : nodes[i];
+	}
+	return true;
+}
+
+//ԤԷӦ֣߳ӺȡûжԷӣа淶ţ
+void ChessEngine::fillPonderMove(SearchState &s, ChessEngineResult &result)
+{
+	ChessPosition &pos = s.pos;
+	const int N = pos.boardSize;
+	const int m = place(result.move[0], result.move[1], result.move[2], N);
+	if (m < 0 || m >= pos.cells || pos.board[m] != 0)
+		return;
+	if (!PositionMake(pos, m))
+	{
+		int sym = 0, score = 0, reply = -1;
+		const uint64_t key = PositionCanonicalHash(pos, &sym);
+		probeTT(key, 0, 0, -WinScore, WinScore, score, reply);
+		if (reply >= 0 && reply < pos.cells && pos.symmetry)
+			reply = pos.symmetry[(size_t)SymmetryInverse(sym) * pos.cells + reply];
+		if (reply >= 0 && reply < pos.cells && pos.board[reply] == 0)
+		{
+			result.ponderMove[0] = reply % N + 1;
+			result.ponderMove[1] = reply / N % N + 1;
+			result.ponderMove[2] = reply / (N * N) + 1;
+		}
+	}
+	PositionUnmake(pos);
+}
+
+//⣺Թ淶ţȡù淶ϣĶԳ任صǰ
+//maxDepthĽã޵ñ棨ĳʱĽǿԾ˳仯
+bool ChessEngine::probeBook(const SearchState &s, int minDepth, int maxDepth, ChessEngineResult &result) const
+{
+	const ChessPosition &pos = s.pos;
+	if (_book == nullptr || _book->boardSize() != pos.boardSize || pos.symmetry == nullptr)
+		return false;
+	int sym = 0;
+	ChessBookEntry e;
+	if (!_book->probe(PositionCanonicalHash(pos, &sym), e) || e.move < 0 || e.move >= pos.cells)
+		return false;
+	if ((e.depth < minDepth && !(e.flags & ChessBookSolved)) || e.depth > maxDepth)
+		return false;
+	const int m = pos.symmetry[(size_t)SymmetryInverse(sym) * pos.cells + e.move];
+	if (pos.board[m] != 0)
+		return false;
+	const int N = pos.boardSize;
+	result.move[0] = m % N + 1;
+	result.move[1] = m / N % N + 1;
+	result.move[2] = m / (N * N) + 1;
+	result.score = e.score;
+	result.depth = e.depth;
+	return true;
+}
+
+//ѸдؿдĿ⣨ֻд㹻֤ʤĽ
+void ChessEngine::storeBook(const SearchState &s, const ChessEngineResult &result, int minDepth, bool solved)
+{
+	const ChessPosition &pos = s.pos;
+	if (_book == nullptr || !_book->writable() || _book->boardSize() != pos.boardSize || pos.symmetry == nullptr)
+		return;
+	if (result.depth < minDepth && !solved)
+		return;
+	const int N = pos.boardSize;
+	int sym = 0;
+	const uint64_t key = PositionCanonicalHash(pos, &sym);
+	const int m = place(result.move[0], result.move[1], result.move[2], N);
+	_book->store(key, pos.symmetry[(size_t)sym * pos.cells + m], result.score, result.depth, solved ? ChessBookSolved : 0);
+}
+
+//̵߳ĵ̴߳ӲͬԴ̣߳resultǿգ¼
+void ChessEngine::searchThread(SearchState &s, int threadIndex, int maxDepth, ChessEngineResult *result)
+{
+	const int N = s.pos.boardSize;
+	int bestMove = -1;
+	if (result)
+	{
+		// δʱıףĵһѡ
+		vector<int32_t> rootMoves;
+		generateMoves(s, 0, -1, rootMoves);
+		bestMove = rootMoves[0];
+	}
+	for (int depth = 1 + threadIndex % 2; depth <= maxDepth && depth < MaxPly; depth++)
+	{
+		s.rootBestMove = -1;
+		int score = search(s, depth, 0, -WinScore, WinScore);
+		if (_stop.load() || s.rootBestMove < 0)
+			break;
+		if (result)
+		{
+			bestMove = s.rootBestMove;
+			result->score = score;
+			result->depth = depth;
+		}
+		if (score >= WinScore - MaxPly || score <= -WinScore + MaxPly)
+			break;
+	}
+	if (result)
+	{
+		result->move[0] = bestMove % N + 1;
+		result->move[1] = bestMove / N % N + 1;
+		result->move[2] = bestMove / (N * N) + 1;
+	}
+}
+
+//ÿ1024ڵһʱڵ
+bool ChessEngine::checkLimits(SearchState &s)
+{
+	if ((++s.nodes & 1023) == 0)
+	{
+		uint64_t total = _totalNodes.fetch_add(1024, memory_order_relaxed) + 1024;
+		if (_maxNodes > 0 && total >= _maxNodes)
+			_stop = true;
+		else
+		{
+			const int64_t deadline = _deadlineNs.load(memory_order_acquire);
+			if (deadline != INT64_MAX &&
+			        chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count() >= deadline)
+				_stop = true;
+		}
+	}
+	return _stop.load(memory_order_relaxed);
+}
+
+//ֵʽalpha-betaԵǰӷӽ
+int ChessEngine::search(SearchState &s, int depth, int ply, int alpha, int beta)
+{
+	if (checkLimits(s))
+		return 0;
+	const int me = s.pos.side;
+	// ֵһгģһֳ
+	if (s.pos.lines.open[me][4] > 0)
+	{
+		if (ply == 0)
+		{
+			vector<int32_t> &moves = s.moveLists[0];
+			generateMoves(s, 0, -1, moves);
+			s.rootBestMove = moves[0];
+		}
+		return WinScore - ply - 1;
+	}
+	if (depth <= 0 || ply >= MaxPly - 1)
+		return evaluate(s);
+
+	// ûԹ淶ϣΪ48ȼ۾湲ñеӰ淶
+	int sym = 0;
+	const uint64_t key = PositionCanonicalHash(s.pos, &sym);
+	int ttScore = 0, ttMove = -1;
+	bool ttHit = probeTT(key, depth, ply, alpha, beta, ttScore, ttMove);
+	if (ttMove >= 0 && s.pos.symmetry)
+		ttMove = s.pos.symmetry[(size_t)SymmetryInverse(sym) * s.pos.cells + ttMove];
+	if (ttHit && ply > 0)
+		return ttScore;
+
+	vector<int32_t> &moves = s.moveLists[ply];
+	generateMoves(s, ply, ttMove, moves);
+	if (moves.empty())
+		return 0;
+
+	const int origAlpha = alpha;
+	int best = -WinScore - 1, bestMove = -1;
+	for (size_t i = 0; i < moves.size(); i++)
+	{
+		int m = moves[i];
+		bool five = PositionMake(s.pos, m);
+		int score = five ? WinScore - ply - 1 : -search(s, depth - 1, ply + 1, -beta, -alpha);
+		PositionUnmake(s.pos);
+		if (_stop.load(memory_order_relaxed))
+			return 0;
+		if (score > best)
+		{
+			best = score;
+			bestMove = m;
+			if (ply == 0)
+				s.rootBestMove = m;
+		}
+		if (score > alpha)
+			alpha = score;
+		if (alpha >= beta)
+		{
+			if (m != s.killers[ply][0])
+			{
+				s.killers[ply][1] = s.killers[ply][0];
+				s.killers[ply][0] = m;
+			}
+			s.history[(size_t)m * 2 + me] += depth * depth;
+			break;
+		}
+	}
+
+	int bound = best <= origAlpha ? BoundUpper : (best >= beta ? BoundLower : BoundExact);
+	if (bestMove >= 0 && s.pos.symmetry)
+		bestMove = s.pos.symmetry[(size_t)sym * s.pos.cells + bestMove];
+	storeTT(key, depth, ply, best, bound, bestMove);
+	return best;
+}
+
+//ֵ߲άμʱη֣ӷӽ
+int ChessEngine::evaluate(const SearchState &s) const
+{
+	const int me = s.pos.side, opp = me ^ 1;
+	int score = 0;
+	if (s.pos.track & PositionTrackPatterns)
+		score = PatternEvalScore(s.pos.patterns, me);
+	else
+	{
+		for (int k = 1; k <= 4; k++)
+			score += LineWeights[k] * (s.pos.lines.open[me][k] - s.pos.lines.open[opp][k]);
+	}
+	const int limit = WinScore / 2;
+	return score > limit ? limit : (score < -limit ? -limit : score);
+}
+
+//ѡ㣺ΧһڵĿλûӡ߹ֵɱ֡ʷ
+void ChessEngine::generateMoves(SearchState &s, int ply, int ttMove, vector<int32_t> &moves)
+{
+	const int me = s.pos.side, opp = me ^ 1;
+	const ChessLineTable &t = *s.pos.lines.table;
+	moves.assign(s.pos.candidates.cells.begin(), s.pos.candidates.cells.end());
+
+	s.scored.resize(moves.size());
+	for (size_t i = 0; i < moves.size(); i++)
+	{
+		int m = moves[i];
+		int64_t key = 0;
+		for (int32_t j = t.cellOffsets[m]; j < t.cellOffsets[(size_t)m + 1]; j++)
+		{
+			const uint8_t *cnt = &s.pos.lines.counts[(size_t)t.cellLines[j] * 2];
+			if (cnt[opp] == 0)
+				key += AttackWeights[cnt[me]];
+			if (cnt[me] == 0)
+				key += DefendWeights[cnt[opp]];
+		}
+		key = key * 1024 + min<int64_t>(s.history[(size_t)m * 2 + me], 1023);
+		if (m == s.killers[ply][0] || m == s.killers[ply][1])
+			key += 512 * 1024;
+		if (m == ttMove)
+			key = INT64_MAX;
+		s.scored[i] = make_pair(key, m);
+	}
+	size_t keep = ply == 0 ? moves.size() : min(moves.size(), (size_t)_maxCandidates);
+	partial_sort(s.scored.begin(), s.scored.begin() + keep, s.scored.end(), [](const pair<int64_t, int32_t> &a,
+	             const pair<int64_t, int32_t> &b)
+	{
+		return a.first > b.first;
+	});
+	moves.resize(keep);
+	for (size_t i = 0; i < keep; i++)
+		moves[i] = s.scored[i].second;
+}
+
+//data֣[0,24)+1[24,40)+32768[40,48)ȣ[48,50)߽
+bool ChessEngine::probeTT(uint64_t key, int depth, int ply, int alpha, int beta, int &score, int &move) const
+{
+	const TTEntry &e = _tt[key & _ttMask];
+	uint64_t d = e.data.load(memory_order_relaxed);
+	if (d == 0 || (e.check.load(memory_order_relaxed) ^ d) != key)
+		return false;
+	move = (int)(d & 0xFFFFFF) - 1;
+	int sc = (int)((d >> 24) & 0xFFFF) - 32768;
+	int dp = (int)((d >> 40) & 0xFF);
+	int bound = (int)((d >> 48) & 3);
+	if (dp < depth)
+		return false;
+	// ʤԵǰڵĲ
+	if (sc >= WinScore - MaxPly * 2)
+		sc -= ply;
+	else if (sc <= -WinScore + MaxPly * 2)
+		sc += ply;
+	if (bound == BoundExact || (bound == BoundLower && sc >= beta) || (bound == BoundUpper && sc <= alpha))
+	{
+		score = sc;
+		return true;
+	}
+	return false;
+}
+
+void ChessEngine::storeTT(uint64_t key, int depth, int ply, int score, int bound, int move)
+{
+	TTEntry &e = _tt[key & _ttMask];
+	uint64_t old = e.data.load(memory_order_relaxed);
+	if ((e.check.load(memory_order_relaxed) ^ old) == key && (int)((old >> 40) & 0xFF) > depth)
+		return;
+	if (score >= WinScore - MaxPly * 2)
+		score += ply;
+	else if (score <= -WinScore + MaxPly * 2)
+		score -= ply;
+	uint64_t d = (uint64_t)(move + 1) & 0xFFFFFF;
+	d |= (uint64_t)(score + 32768) << 24;
+	d |= (uint64_t)depth << 40;
+	d |= (uint64_t)bound << 48;
+	e.check.store(key ^ d, memory_order_relaxed);
+	e.data.store(d, memory_order_relaxed);
+}
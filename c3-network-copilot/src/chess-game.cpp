@@ -2,9 +2,19 @@
 #include <iostream>
 #include <limits>
 #include "../include/chess-game.h"
+#include "../include/chess-candidates.h"
+#include "../include/chess-log.h"
 //λ߼ϵxyzxyzBoardSize=5*(ChessBoard+17)Ӧλþǣ241㹫ʽ17=2-1+4-1* 5 +1-1* 25
 using namespace std;
 
+const char *const ChessDirectionNames[ChessDirectionCount] =
+{
+	"x-axis", "y-axis", "z-axis",
+	"xy-diagonal", "xy-diagonal",
+	"yz-diagonal", "yz-diagonal",
+	"xz-diagonal", "xz-diagonal",
+	"space-diagonal", "space-diagonal", "space-diagonal", "space-diagonal"
+};
 
 //Ӵ洢λ
 int place(int x, int y, int z, int BoardSize)
@@ -27,6 +37,7 @@ bool OnlineInitChessBoard(char **pChessBoard, int BoardSize)
 //λ
 void NativeGetChessPosition(int input[])
 {
+	ChessLogFlush();
 	cout << "Enter the location where you want to place your order. Use the form like x y z." << endl;
 	while (true)
 	{
@@ -44,13 +55,13 @@ void NativeGetChessPosition(int input[])
 
 
 //ºλúϷԣϷ֣Ƿ
-bool UpdateBoardState(int BoardSize, char *ChessBoard, int input[], char player)
+bool UpdateBoardState(int BoardSize, char *ChessBoard, int input[], char player, ChessCandidates *pCandidates)
 {
 	// Ƿ̷Χ
 	if (input[0] < 1 || input[0] > BoardSize || input[1] < 1 || input[1] > BoardSize || input[2] < 1
 	        || input[2] > BoardSize)
 	{
-		cout << "INVALID_MOVE: Position is out of the board range." << endl; // Ƿ
+		CHESS_LOG_INFO("INVALID_MOVE: Position is out of the board range."); // Ƿ
 		return false;
 	}
 
@@ -60,14 +71,15 @@ bool UpdateBoardState(int BoardSize, char *ChessBoard, int input[], char player)
 	// ĿλǷ
 	if (ChessBoard[newChessIndex] != 0)
 	{
-		cout << "INVALID_MOVE: A chess piece already exists at this position." << endl; // Ƿ
+		CHESS_LOG_INFO("INVALID_MOVE: A chess piece already exists at this position."); // Ƿ
 		return false;
 	}
 
 	// λúϷ״̬
 	ChessBoard[newChessIndex] = player;
-	cout << "MOVE_ACCEPTED: Board updated. Player " << player << " placed a piece at (" << input[0] << ", " << input[1] <<
-	     ", " << input[2] << ")." << endl;
+	if (pCandidates)
+		CandidatesPlace(*pCandidates, newChessIndex);
+	CHESS_LOG_DEBUG("MOVE_ACCEPTED: Board updated. Player %c placed a piece at (%d, %d, %d).", player, input[0], input[1], input[2]);
 
 	// ڴ˿Եһӡ״̬ҪĻ
 	// : PrintBoard(BoardSize, ChessBoard);
@@ -75,180 +87,56 @@ bool UpdateBoardState(int BoardSize, char *ChessBoard, int input[], char player)
 	return true;
 }
 
-//ӵΪļ9*9*9ĿռǷŵ5ӣ˭ӮԼôӮĲ1޷0ּûԼռ
+//ӵΪļ13ϡ4Ƿŵ5ӣ˭ӮԼôӮĲ1޷0õ÷
+//ÿȡ9ƴһ9λڣFindFiveDirectionλһԼȫ
 int CheckWin(int BoardSize, char *ChessBoard, int input[], char player)
 {
 	int x = input[0], y = input[1], z = input[2];
-	int xmax = (x + 4 <= BoardSize) ? (x + 4) : BoardSize;
-	int xmin = (x - 4 >= 1) ? (x - 4) : 1;
-	int ymax = (y + 4 <= BoardSize) ? (y + 4) : BoardSize;
-	int ymin = (y - 4 >= 1) ? (y - 4) : 1;
-	int zmax = (z + 4 <= BoardSize) ? (z + 4) : BoardSize;
-	int zmin = (z - 4 >= 1) ? (z - 4) : 1;
-	//x
-	for (int i = xmin; i + 4 <= xmax; i++)
-	{
-		if (*(ChessBoard + place(i, y, z, BoardSize)) == player &&
-		        *(ChessBoard + place(i + 1, y, z, BoardSize)) == player &&
-		        *(ChessBoard + place(i + 2, y, z, BoardSize)) == player &&
-		        *(ChessBoard + place(i + 3, y, z, BoardSize)) == player &&
-		        *(ChessBoard + place(i + 4, y, z, BoardSize)) == player)
-		{
-			printf("The player%c wins! In the x-axis direction\n", player);
-			return 1;
-		}
-	}
-	//y
-	for (int j = ymin; j + 4 <= ymax; j++)
-	{
-		if (*(ChessBoard + place(x, j, z, BoardSize)) == player &&
-		        *(ChessBoard + place(x, j + 1, z, BoardSize)) == player &&
-		        *(ChessBoard + place(x, j + 2, z, BoardSize)) == player &&
-		        *(ChessBoard + place(x, j + 3, z, BoardSize)) == player &&
-		        *(ChessBoard + place(x, j + 4, z, BoardSize)) == player)
-		{
-			printf("The player%c wins! In the y-axis direction\n", player);
-			return 1;
-		}
-	}
-	//z
-	for (int k = zmin; k + 4 <= zmax; k++)
-	{
-		if (*(ChessBoard + place(x, y, k, BoardSize)) == player &&
-		        *(ChessBoard + place(x, y, k + 1, BoardSize)) == player &&
-		        *(ChessBoard + place(x, y, k + 2, BoardSize)) == player &&
-		        *(ChessBoard + place(x, y, k + 3, BoardSize)) == player &&
-		        *(ChessBoard + place(x, y, k + 4, BoardSize)) == player)
-		{
-			printf("The player%c wins! In the z-axis direction\n", player);
-			return 1;
-		}
-	}
-	//xyԽ߷
-	for (int i = xmin, j = ymin; i + 4 <= xmax && j + 4 <= ymax; i++, j++)
-	{
-		if (*(ChessBoard + place(i, j, z, BoardSize)) == player &&
-		        *(ChessBoard + place(i + 1, j + 1, z, BoardSize)) == player &&
-		        *(ChessBoard + place(i + 2, j + 2, z, BoardSize)) == player &&
-		        *(ChessBoard + place(i + 3, j + 3, z, BoardSize)) == player &&
-		        *(ChessBoard + place(i + 4, j + 4, z, BoardSize)) == player)
-		{
-			printf("The player%c wins! In the xy-diagonal direction\n", player);
-			return 1;
-		}
-	}
-	for (int i = xmax, j = ymin; i - 4 >= xmin && j + 4 <= ymax; i--, j++)
-	{
-		if (*(ChessBoard + place(i, j, z, BoardSize)) == player &&
-		        *(ChessBoard + place(i - 1, j + 1, z, BoardSize)) == player &&
-		        *(ChessBoard + place(i - 2, j + 2, z, BoardSize)) == player &&
-		        *(ChessBoard + place(i - 3, j + 3, z, BoardSize)) == player &&
-		        *(ChessBoard + place(i - 4, j + 4, z, BoardSize)) == player)
-		{
-			printf("The player%c wins! In the xy-diagonal direction\n", player);
-			return 1;
-		}
-	}
-	//yzԽ߷
-	for (int j = ymin, k = zmin; j + 4 <= ymax && k + 4 <= zmax; j++, k++)
-	{
-		if (*(ChessBoard + place(x, j, k, BoardSize)) == player &&
-		        *(ChessBoard + place(x, j + 1, k + 1, BoardSize)) == player &&
-		        *(ChessBoard + place(x, j + 2, k + 2, BoardSize)) == player &&
-		        *(ChessBoard + place(x, j + 3, k + 3, BoardSize)) == player &&
-		        *(ChessBoard + place(x, j + 4, k + 4, BoardSize)) == player)
-		{
-			printf("The player%c wins! In the yz-diagonal direction\n", player);
-			return 1;
-		}
-	}
-	for (int j = ymax, k = zmin; j - 4 >= ymin && k + 4 <= zmax; j--, k++)
+	uint32_t windows[ChessDirectionCount];
+	for (int d = 0; d < ChessDirectionCount; d++)
 	{
-		if (*(ChessBoard + place(x, j, k, BoardSize)) == player &&
-		        *(ChessBoard + place(x, j - 1, k + 1, BoardSize)) == player &&
-		        *(ChessBoard + place(x, j - 2, k + 2, BoardSize)) == player &&
-		        *(ChessBoard + place(x, j - 3, k + 3, BoardSize)) == player &&
-		        *(ChessBoard + place(x, j - 4, k + 4, BoardSize)) == player)
+		int dx = ChessDirections[d][0], dy = ChessDirections[d][1], dz = ChessDirections[d][2];
+		int step = dx + dy * BoardSize + dz * BoardSize * BoardSize;
+		int cx = x - 4 * dx, cy = y - 4 * dy, cz = z - 4 * dz;
+		int index = place(cx, cy, cz, BoardSize);
+		uint32_t w = 0;
+		for (int k = 0; k < 9; k++, cx += dx, cy += dy, cz += dz, index += step)
 		{
-			printf("The player%c wins! In the yz-diagonal direction\n", player);
-			return 1;
+			if (cx >= 1 && cx <= BoardSize && cy >= 1 && cy <= BoardSize && cz >= 1 && cz <= BoardSize
+			        && ChessBoard[index] == player)
+				w |= 1u << k;
 		}
+		windows[d] = w;
 	}
-	//xzԽ߷
-	for (int i = xmin, k = zmin; i + 4 <= xmax && k + 4 <= zmax; i++, k++)
+	int dir = FindFiveDirection(windows);
+	if (dir >= 0)
 	{
-		if (*(ChessBoard + place(i, y, k, BoardSize)) == player &&
-		        *(ChessBoard + place(i + 1, y, k + 1, BoardSize)) == player &&
-		        *(ChessBoard + place(i + 2, y, k + 2, BoardSize)) == player &&
-		        *(ChessBoard + place(i + 3, y, k + 3, BoardSize)) == player &&
-		        *(ChessBoard + place(i + 4, y, k + 4, BoardSize)) == player)
-		{
-			printf("The player%c wins! In the xz-diagonal direction\n", player);
-			return 1;
-		}
+		CHESS_LOG_INFO("The player%c wins! In the %s direction", player, ChessDirectionNames[dir]);
+		return 1;
 	}
-	for (int i = xmax, k = zmin; i - 4 >= xmin && k + 4 <= zmax; i--, k++)
-	{
-		if (*(ChessBoard + place(i, y, k, BoardSize)) == player &&
-		        *(ChessBoard + place(i - 1, y, k + 1, BoardSize)) == player &&
-		        *(ChessBoard + place(i - 2, y, k + 2, BoardSize)) == player &&
-		        *(ChessBoard + place(i - 3, y, k + 3, BoardSize)) == player &&
-		        *(ChessBoard + place(i - 4, y, k + 4, BoardSize)) == player)
-		{
-			printf("The player%c wins! In the xz-diagonal direction\n", player);
-			return 1;
-		}
-	}
-	//ռԽ߷
-	for (int i = xmin, j = ymin, k = zmin; i + 4 <= xmax && j + 4 <= ymax && k + 4 <= zmax; i++, j++, k++)
-	{
-		if (*(ChessBoard + place(i, j, k, BoardSize)) == player &&
-		        *(ChessBoard + place(i + 1, j + 1, k + 1, BoardSize)) == player &&
-		        *(ChessBoard + place(i + 2, j + 2, k + 2, BoardSize)) == player &&
-		        *(ChessBoard + place(i + 3, j + 3, k + 3, BoardSize)) == player &&
-		        *(ChessBoard + place(i + 4, j + 4, k + 4, BoardSize)) == player)
-		{
-			printf("The player%c wins! In the space-diagonal direction\n", player);
-			return 1;
-		}
-	}
-	for (int i = xmax, j = ymin, k = zmin; i - 4 >= xmin && j + 4 <= ymax && k + 4 <= zmax; i--, j++, k++)
-	{
-		if (*(ChessBoard + place(i, j, k, BoardSize)) == player &&
-		        *(ChessBoard + place(i - 1, j + 1, k + 1, BoardSize)) == player &&
-		        *(ChessBoard + place(i - 2, j + 2, k + 2, BoardSize)) == player &&
-		        *(ChessBoard + place(i - 3, j + 3, k + 3, BoardSize)) == player &&
-		        *(ChessBoard + place(i - 4, j + 4, k + 4, BoardSize)) == player)
-		{
-			printf("The player%c wins! In the space-diagonal direction\n", player);
-			return 1;
-		}
-	}
-	for (int i = xmin, j = ymax, k = zmin; i + 4 <= xmax && j - 4 >= ymin && k + 4 <= zmax; i++, j--, k++)
-	{
-		if (*(ChessBoard + place(i, j, k, BoardSize)) == player &&
-		        *(ChessBoard + place(i + 1, j - 1, k + 1, BoardSize)) == player &&
-		        *(ChessBoard + place(i + 2, j - 2, k + 2, BoardSize)) == player &&
-		        *(ChessBoard + place(i + 3, j - 3, k + 3, BoardSize)) == player &&
-		        *(ChessBoard + place(i + 4, j - 4, k + 4, BoardSize)) == player)
-		{
-			printf("The player%c wins! In the space-diagonal direction\n", player);
-			return 1;
-		}
-	}
-	for (int i = xmax, j = ymax, k = zmin; i - 4 >= xmin && j - 4 >= ymin && k + 4 <= zmax; i--, j--, k++)
-	{
-		if (*(ChessBoard + place(i, j, k, BoardSize)) == player &&
-		        *(ChessBoard + place(i - 1, j - 1, k + 1, BoardSize)) == player &&
-		        *(ChessBoard + place(i - 2, j - 2, k + 2, BoardSize)) == player &&
-		        *(ChessBoard + place(i - 3, j - 3, k + 3, BoardSize)) == player &&
-		        *(ChessBoard + place(i - 4, j - 4, k + 4, BoardSize)) == player)
+	return 0;
+}
+
+//139λڰÿ10λ10λΪ0ϣװ364λ֣ÿ6
+//w & w>>1 & w>>2 & w>>3 & w>>4 Ϊ0˵ĳ5λ
+int FindFiveDirection(const uint32_t windows[ChessDirectionCount])
+{
+	uint64_t lanes[3] = { 0, 0, 0 };
+	for (int d = 0; d < ChessDirectionCount; d++)
+		lanes[d / 6] |= (uint64_t)(windows[d] & 0x1FFu) << ((d % 6) * 10);
+	for (int l = 0; l < 3; l++)
+	{
+		uint64_t w = lanes[l];
+		uint64_t run = w & (w >> 1) & (w >> 2) & (w >> 3) & (w >> 4);
+		if (run == 0)
+			continue;
+		for (int s = 0; s < 6; s++)
 		{
-			printf("The player%c wins! In the space-diagonal direction\n", player);
-			return 1;
+			if ((run >> (s * 10)) & 0x1Fu)
+				return l * 6 + s;
 		}
 	}
-	return 0;
+	return -1;
 }
 /*
 
@@ -0,0 +1,150 @@
+#include <map>
+#include <memory>
+#include <mutex>
+#include "../include/chess-lines.h"
+using namespace std;
+
+
+//ö13Ϸ5ߣٰӽCSRʽķ
+static unique_ptr<ChessLineTable> BuildChessLineTable(int BoardSize)
+{
+	unique_ptr<ChessLineTable> t(new ChessLineTable());
+	t->boardSize = BoardSize;
+	const int cells = BoardSize * BoardSize * BoardSize;
+	for (int d = 0; d < ChessDirectionCount; d++)
+	{
+		int dx = ChessDirections[d][0], dy = ChessDirections[d][1], dz = ChessDirections[d][2];
+		for (int z = 1; z <= BoardSize; z++)
+		{
+			for (int y = 1; y <= BoardSize; y++)
+			{
+				for (int x = 1; x <= BoardSize; x++)
+				{
+					int ex = x + 4 * dx, ey = y + 4 * dy, ez = z + 4 * dz;
+					if (ex < 1 || ex > BoardSize || ey < 1 || ey > BoardSize || ez < 1 || ez > BoardSize)
+						continue;
+					for (int k = 0; k < 5; k++)
+						t->lineCells.push_back(place(x + k * dx, y + k * dy, z + k * dz, BoardSize));
+					t->lineDirs.push_back((uint8_t)d);
+				}
+			}
+		}
+	}
+	t->lineCount = (int)t->lineDirs.size();
+
+	t->cellOffsets.assign((size_t)cells + 1, 0);
+	for (int32_t c : t->lineCells)
+		t->cellOffsets[(size_t)c + 1]++;
+	for (int c = 0; c < cells; c++)
+		t->cellOffsets[(size_t)c + 1] += t->cellOffsets[c];
+	t->cellLines.resize(t->lineCells.size());
+	vector<int32_t> fill(t->cellOffsets.begin(), t->cellOffsets.end() - 1);
+	for (int i = 0; i < t->lineCount; i++)
+	{
+		for (int k = 0; k < 5; k++)
+			t->cellLines[fill[t->lineCells[(size_t)i * 5 + k]]++] = i;
+	}
+	return t;
+}
+
+const ChessLineTable *GetChessLineTable(int BoardSize)
+{
+	if (BoardSize < 1 || BoardSize > ChessLineTableMaxSize)
+		return nullptr;
+	static mutex tablesMutex;
+	static map<int, unique_ptr<ChessLineTable>> tables;
+	lock_guard<mutex> lk(tablesMutex);
+	unique_ptr<ChessLineTable> &slot = tables[BoardSize];
+	if (!slot)
+		slot = BuildChessLineTable(BoardSize);
+	return slot.get();
+}
+
+bool InitLineCounters(ChessLineCounters *pCounters, int BoardSize)
+{
+	pCounters->table = GetChessLineTable(BoardSize);
+	if (pCounters->table == nullptr)
+	{
+		FreeLineCounters(pCounters);
+		return false;
+	}
+	pCounters->counts.assign((size_t)pCounters->table->lineCount * 2, 0);
+	for (int p = 0; p < 2; p++)
+	{
+		for (int k = 0; k < 6; k++)
+			pCounters->open[p][k] = 0;
+		pCounters->open[p][0] = pCounters->table->lineCount;
+	}
+	return true;
+}
+
+void FreeLineCounters(ChessLineCounters *pCounters)
+{
+	pCounters->table = nullptr;
+	vector<uint8_t>().swap(pCounters->counts);
+	for (int p = 0; p < 2; p++)
+	{
+		for (int k = 0; k < 6; k++)
+			pCounters->open[p][k] = 0;
+	}
+}
+
+//ڸk->k+1ӣԷ߼֮ƶԭԷĻ߱Ϊ
+bool LineCountersPlace(ChessLineCounters &counters, int cell, int plane)
+{
+	const ChessLineTable &t = *counters.table;
+	const int other = 1 - plane;
+	bool five = false;
+	for (int32_t i = t.cellOffsets[cell]; i < t.cellOffsets[(size_t)cell + 1]; i++)
+	{
+		uint8_t *c = &counters.counts[(size_t)t.cellLines[i] * 2];
+		int mine = c[plane], theirs = c[other];
+		if (theirs == 0)
+		{
+			counters.open[plane][mine]--;
+			counters.open[plane][mine + 1]++;
+		}
+		if (mine == 0)
+		{
+			counters.open[other][theirs]--;
+		}
+		c[plane] = (uint8_t)(mine + 1);
+		if (mine + 1 == 5)
+			five = true;
+	}
+	return five;
+}
+
+//LineCountersPlace
+void LineCountersRemove(ChessLineCounters &counters, int cell, int plane)
+{
+	const ChessLineTable &t = *counters.table;
+	const int other = 1 - plane;
+	for (int32_t i = t.cellOffsets[cell]; i < t.cellOffsets[(size_t)cell + 1]; i++)
+	{
+		uint8_t *c = &counters.counts[(size_t)t.cellLines[i] * 2];
+		int mine = c[plane], theirs = c[other];
+		if (theirs == 0)
+		{
+			counters.open[plane][mine]--;
+			counters.open[plane][mine - 1]++;
+		}
+		if (mine == 1)
+		{
+			counters.open[other][theirs]++;
+		}
+		c[plane] = (uint8_t)(mine - 1);
+	}
+}
+
+int LineCountersWinDirection(const ChessLineCounters &counters, int cell, int plane)
+{
+	const ChessLineTable &t = *counters.table;
+	for (int32_t i = t.cellOffsets[cell]; i < t.cellOffsets[(size_t)cell + 1]; i++)
+	{
+		int32_t line = t.cellLines[i];
+		if (counters.counts[(size_t)line * 2 + plane] == 5)
+			return t.lineDirs[line];
+	}
+	return -1;
+}
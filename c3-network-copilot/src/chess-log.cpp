@@ -0,0 +1,246 @@
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../include/chess-log.h"
+using namespace std;
+
+//ÿ̵߳Ļλ2ݣ
+static const uint64_t LogRingSlots = 512;
+
+struct LogRecord
+{
+	uint64_t seq;                        // ȫţ̨߳̾ݴ˺ϲ̵߳ļ¼
+	uint32_t length;                     // βз
+	char text[ChessLogLineMax + 2];
+};
+
+//ߣ̣߳ߣ̨̣߳headֻƽtailֻƽ
+struct LogRing
+{
+	atomic<uint64_t> head{ 0 };
+	atomic<uint64_t> tail{ 0 };
+	atomic<bool> orphaned{ false };      // ߳˳ȡպ
+	LogRecord records[LogRingSlots];
+};
+
+struct LogState
+{
+	mutex ringsMutex;                    // ֻڵǼ̡̨߳߳FlushȡʱУI/O
+	vector<shared_ptr<LogRing>> rings;
+	vector<shared_ptr<LogRing>> snapshot;  // ֺ̨̱߳ϲĻбֻɺ̨߳ʹ
+	mutex wakeMutex;
+	condition_variable wake;             // лɿձΪǿʱѺ̨߳
+	atomic<bool> pending{ false };       // δĻѣ߾ݴʡظ֪ͨ
+	atomic<uint64_t> seq{ 0 };
+	atomic<int> level{ ChessLogDebug };
+	atomic<uint64_t> dropped{ 0 };
+	uint64_t reportedDropped{ 0 };
+	atomic<bool> running{ false };
+	once_flag startOnce;
+	thread writer;
+	char out[1 << 16];                   // ϲ壬ֻɺ̨߳ʹ
+
+	~LogState();
+};
+
+static LogState &GetLogState()
+{
+	static LogState state;
+	return state;
+}
+
+//Ѹ߳ѷļ¼źϲ
+//ֻȡбĿգ˳˳ȡյ̵߳Ļ壩ϲдstdout
+static void DrainLogRings(LogState &s)
+{
+	{
+		lock_guard<mutex> lk(s.ringsMutex);
+		for (size_t i = 0; i < s.rings.size(); )
+		{
+			LogRing &r = *s.rings[i];
+			if (r.orphaned.load(memory_order_acquire) && r.tail.load(memory_order_relaxed) == r.head.load(memory_order_acquire))
+			{
+				s.rings[i] = s.rings.back();
+				s.rings.pop_back();
+			}
+			else
+			{
+				i++;
+			}
+		}
+		s.snapshot = s.rings;
+	}
+	size_t used = 0;
+	bool any = false;
+	while (true)
+	{
+		LogRing *best = nullptr;
+		uint64_t bestSeq = ~0ull;
+		for (const shared_ptr<LogRing> &r : s.snapshot)
+		{
+			uint64_t t = r->tail.load(memory_order_relaxed);
+			if (t == r->head.load(memory_order_acquire))
+				continue;
+			const LogRecord &rec = r->records[t & (LogRingSlots - 1)];
+			if (rec.seq < bestSeq)
+			{
+				bestSeq = rec.seq;
+				best = r.get();
+			}
+		}
+		if (best == nullptr)
+			break;
+		uint64_t t = best->tail.load(memory_order_relaxed);
+		const LogRecord &rec = best->records[t & (LogRingSlots - 1)];
+		if (used + rec.length > sizeof(s.out))
+		{
+			fwrite(s.out, 1, used, stdout);
+			used = 0;
+		}
+		memcpy(s.out + used, rec.text, rec.length);
+		used += rec.length;
+		best->tail.store(t + 1, memory_order_release);
+		any = true;
+	}
+	if (used > 0)
+		fwrite(s.out, 1, used, stdout);
+	uint64_t dropped = s.dropped.load(memory_order_relaxed);
+	if (dropped != s.reportedDropped)
+	{
+		fprintf(stdout, "[log] %llu־򻺳\n", (unsigned long long)(dropped - s.reportedDropped));
+		s.reportedDropped = dropped;
+	}
+	if (any)
+		fflush(stdout);
+}
+
+//û¼¼ʱϵȴʱֻڻ˳̵߳Ļ뱨涪
+static void LogWriterLoop(LogState *s)
+{
+	while (s->running.load(memory_order_acquire))
+	{
+		{
+			unique_lock<mutex> lk(s->wakeMutex);
+			s->wake.wait_for(lk, chrono::milliseconds(100), [s]()
+			{
+				return s->pending.load(memory_order_acquire) || !s->running.load(memory_order_acquire);
+			});
+		}
+		// ־ٺϲ֮󷢲ļ¼λ֪ͨ
+		s->pending.exchange(false, memory_order_acq_rel);
+		DrainLogRings(*s);
+	}
+	DrainLogRings(*s);
+}
+
+LogState::~LogState()
+{
+	{
+		lock_guard<mutex> lk(wakeMutex);
+		running.store(false, memory_order_release);
+	}
+	wake.notify_one();
+	if (writer.joinable())
+		writer.join();
+}
+
+//߳˳ʱѻΪɻգʣ¼Իᱻ
+struct LogRingHolder
+{
+	shared_ptr<LogRing> ring;
+	~LogRingHolder()
+	{
+		if (ring)
+			ring->orphaned.store(true, memory_order_release);
+	}
+};
+
+static LogRing *ThreadLogRing(LogState &s)
+{
+	thread_local LogRingHolder holder;
+	if (!holder.ring)
+	{
+		holder.ring = make_shared<LogRing>();
+		{
+			lock_guard<mutex> lk(s.ringsMutex);
+			s.rings.push_back(holder.ring);
+		}
+		call_once(s.startOnce, [&s]()
+		{
+			s.running.store(true, memory_order_release);
+			s.writer = thread(LogWriterLoop, &s);
+		});
+	}
+	return holder.ring.get();
+}
+
+void ChessLogWrite(int level, const char *format, ...)
+{
+	LogState &s = GetLogState();
+	if (level < s.level.load(memory_order_relaxed))
+		return;
+	LogRing *ring = ThreadLogRing(s);
+	uint64_t head = ring->head.load(memory_order_relaxed);
+	if (head - ring->tail.load(memory_order_acquire) >= LogRingSlots)
+	{
+		s.dropped.fetch_add(1, memory_order_relaxed);
+		return;
+	}
+	LogRecord &rec = ring->records[head & (LogRingSlots - 1)];
+	va_list args;
+	va_start(args, format);
+	int n = vsnprintf(rec.text, ChessLogLineMax + 1, format, args);
+	va_end(args);
+	if (n < 0)
+		n = 0;
+	if (n > ChessLogLineMax)
+		n = ChessLogLineMax;
+	rec.text[n++] = '\n';
+	rec.length = (uint32_t)n;
+	rec.seq = s.seq.fetch_add(1, memory_order_relaxed);
+	ring->head.store(head + 1, memory_order_release);
+	// ֻк̨߳־ĵһ¼Ҫ֪ͨ¼
+	if (!s.pending.exchange(true, memory_order_acq_rel))
+	{
+		lock_guard<mutex> lk(s.wakeMutex);
+		s.wake.notify_one();
+	}
+}
+
+void ChessLogSetLevel(int level)
+{
+	GetLogState().level.store(level, memory_order_relaxed);
+}
+
+int ChessLogGetLevel()
+{
+	return GetLogState().level.load(memory_order_relaxed);
+}
+
+void ChessLogFlush()
+{
+	LogState &s = GetLogState();
+	vector<pair<shared_ptr<LogRing>, uint64_t>> targets;
+	{
+		lock_guard<mutex> lk(s.ringsMutex);
+		for (const shared_ptr<LogRing> &r : s.rings)
+			targets.emplace_back(r, r->head.load(memory_order_acquire));
+	}
+	for (const pair<shared_ptr<LogRing>, uint64_t> &t : targets)
+	{
+		while (t.first->tail.load(memory_order_acquire) < t.second && s.running.load(memory_order_acquire))
+			this_thread::sleep_for(chrono::microseconds(200));
+	}
+}
+
+unsigned long long ChessLogDropped()
+{
+	return GetLogState().dropped.load(memory_order_relaxed);
+}
@@ -0,0 +1,425 @@
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <thread>
+#include "../include/chess-mcts.h"
+#include "../include/chess-game.h"
+#include "../include/chess-log.h"
+using namespace std;
+
+//ĸӣӼֹͣ
+static const char Sentinel = 3;
+//չʱÿڵౣӽڵ
+static const int MaxChildren = 48;
+//Ҷӱʵôչ
+static const int ExpandVisits = 2;
+//UCT̽ϵ
+static const double Exploration = 0.7;
+
+struct ChessMcts::Node
+{
+	atomic<int32_t> visits{ 0 };
+	atomic<int64_t> score{ 0 };          //ӷ÷֣ʤ2ͼ1
+	atomic<int32_t> firstChild{ -1 };    //ӽڵ㷢ΪǸrelease
+	atomic<uint8_t> expanding{ 0 };
+	int32_t childCount{ 0 };
+	int32_t move{ -1 };                  //µλ
+	bool terminal{ false };              //ֱӳ
+};
+
+//ÿ߳˽еģ뻺ʼʱһԷ
+struct ChessMcts::Worker
+{
+	vector<char> board;
+	vector<int64_t> stones;              //ǰ֮Ǳģ
+	size_t rootStones{ 0 };
+	vector<int32_t> path;
+	vector<uint32_t> stamp;
+	uint32_t stampGen{ 0 };
+	vector<pair<int, int64_t>> scored;
+	char rootPlayer{ '1' };
+	uint64_t rng{ 0 };
+	uint64_t playouts{ 0 };
+
+	uint64_t next()
+	{
+		// xorshift64*
+		rng ^= rng >> 12;
+		rng ^= rng << 25;
+		rng ^= rng >> 27;
+		return rng * 0x2545F4914F6CDD1Dull;
+	}
+};
+
+//Ҫŵ¸ڵһӽڵ㣬չʧܡ޴ѡ
+ChessMcts::ChessMcts(size_t maxTreeNodes)
+	: _capacity(max(maxTreeNodes, (size_t)1 + MaxChildren))
+{
+	_nodes.reset(new Node[_capacity]);
+}
+
+ChessMcts::~ChessMcts()
+{
+}
+
+void ChessMcts::stop()
+{
+	_stop = true;
+}
+
+int64_t ChessMcts::toPadded(int cell) const
+{
+	const int N = _boardSize;
+	int x = cell % N, y = cell / N % N, z = cell / (N * N);
+	return (x + 4) + (int64_t)(y + 4) * _pitch + (int64_t)(z + 4) * _layer;
+}
+
+int ChessMcts::toCell(int64_t padded) const
+{
+	const int N = _boardSize;
+	int x = (int)(padded % _pitch) - 4;
+	int y = (int)(padded / _pitch % _pitch) - 4;
+	int z = (int)(padded / _layer) - 4;
+	return x + y * N + z * N * N;
+}
+
+//13ͬɫӣ߿ڱҪ߽ж
+bool ChessMcts::isFive(const char *board, int64_t cell, char who) const
+{
+	for (int d = 0; d < ChessDirectionCount; d++)
+	{
+		const int64_t s = _strides[d];
+		int run = 1;
+		for (int64_t p = cell + s; board[p] == who && run < 5; p += s)
+			run++;
+		for (int64_t p = cell - s; board[p] == who && run < 5; p -= s)
+			run++;
+		if (run >= 5)
+			return true;
+	}
+	return false;
+}
+
+bool ChessMcts::chooseMove(const char *ChessBoard, int BoardSize, char player, const ChessMctsLimits &limits,
+                           ChessMctsResult &result)
+{
+	const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	result = ChessMctsResult();
+	const int N = BoardSize;
+	const int cells = N * N * N;
+	_boardSize = N;
+	_pitch = N + 8;
+	_layer = (int64_t)_pitch * _pitch;
+	for (int d = 0; d < ChessDirectionCount; d++)
+		_strides[d] = ChessDirections[d][0] + (int64_t)ChessDirections[d][1] * _pitch + ChessDirections[d][2] * _layer;
+	int n = 0;
+	for (int dz = -1; dz <= 1; dz++)
+		for (int dy = -1; dy <= 1; dy++)
+			for (int dx = -1; dx <= 1; dx++)
+				if (dx || dy || dz)
+					_neighbors[n++] = (int)(dx + dy * _pitch + dz * _layer);
+	_maxPlayoutMoves = limits.maxPlayoutMoves > 0 ? limits.maxPlayoutMoves : 200;
+
+	// 棺̣߿ڱ
+	Worker root;
+	root.board.assign((size_t)(_layer * _pitch), Sentinel);
+	root.rootPlayer = player;
+	for (int c = 0; c < cells; c++)
+	{
+		int64_t p = toPadded(c);
+		root.board[p] = ChessBoard[c];
+		if (ChessBoard[c] != 0)
+			root.stones.push_back(p);
+	}
+	if ((int)root.stones.size() >= cells)
+		return false;
+	root.rootStones = root.stones.size();
+	root.stamp.assign(root.board.size(), 0);
+	root.rng = 0x9E3779B97F4A7C15ull;
+
+	int bestCell = -1;
+	if (root.stones.empty())
+	{
+		bestCell = place((N + 1) / 2, (N + 1) / 2, (N + 1) / 2, N);
+	}
+	else
+	{
+		_stop = false;
+		_playouts = 0;
+		_used = 1;
+		Node &r = _nodes[0];
+		r.visits = 0;
+		r.score = 0;
+		r.firstChild = -1;
+		r.expanding = 0;
+		r.childCount = 0;
+		r.terminal = false;
+		root.path.assign(1, 0);
+		if (expand(root, 0) < 0 || r.childCount == 0)
+		{
+			CHESS_LOG_ERROR("ERROR expanding MCTS root: no candidate moves");
+			return false;
+		}
+
+		// ֱӳ£Էһܳĵȶ
+		const int32_t first = r.firstChild.load();
+		const char opponent = player == '1' ? '2' : '1';
+		for (int32_t i = 0; i < r.childCount && bestCell < 0; i++)
+		{
+			if (_nodes[first + i].terminal)
+				bestCell = toCell(_nodes[first + i].move);
+		}
+		for (int32_t i = 0; i < r.childCount && bestCell < 0; i++)
+		{
+			int64_t m = _nodes[first + i].move;
+			root.board[m] = opponent;
+			if (isFive(root.board.data(), m, opponent))
+				bestCell = toCell(m);
+			root.board[m] = 0;
+		}
+	}
+
+	int threadCount = limits.threads;
+	if (threadCount <= 0)
+		threadCount = max(1, (int)thread::hardware_concurrency());
+	result.threadPlayouts.assign(threadCount, 0);
+	result.threadPps.assign(threadCount, 0);
+
+	if (bestCell < 0)
+	{
+		const bool hasDeadline = limits.timeMs > 0;
+		const chrono::steady_clock::time_point deadline = start + chrono::milliseconds(limits.timeMs);
+		const uint64_t maxPlayouts = (!hasDeadline && limits.maxPlayouts == 0) ? 10000 : limits.maxPlayouts;
+		vector<Worker> workers(threadCount, root);
+		vector<thread> threads;
+		for (int i = 0; i < threadCount; i++)
+		{
+			workers[i].rng = 0x9E3779B97F4A7C15ull * (i + 1) ^ (uint64_t)start.time_since_epoch().count();
+			if (workers[i].rng == 0)
+				workers[i].rng = 1;
+		}
+		for (int i = 1; i < threadCount; i++)
+			threads.push_back(thread(&ChessMcts::runWorker, this, ref(workers[i]), maxPlayouts, deadline, hasDeadline));
+		runWorker(workers[0], maxPlayouts, deadline, hasDeadline);
+		_stop = true;
+		for (size_t i = 0; i < threads.size(); i++)
+			threads[i].join();
+
+		// ʴӽڵɿ
+		const Node &r = _nodes[0];
+		const int32_t first = r.firstChild.load();
+		int32_t best = first;
+		for (int32_t i = 1; i < r.childCount; i++)
+		{
+			if (_nodes[first + i].visits.load() > _nodes[best].visits.load())
+				best = first + i;
+		}
+		bestCell = toCell(_nodes[best].move);
+		int32_t v = _nodes[best].visits.load();
+		result.winRate = v > 0 ? _nodes[best].score.load() / (2.0 * v) : 0.0;
+		for (int i = 0; i < threadCount; i++)
+			result.threadPlayouts[i] = workers[i].playouts;
+	}
+
+	result.move[0] = bestCell % N + 1;
+	result.move[1] = bestCell / N % N + 1;
+	result.move[2] = bestCell / (N * N) + 1;
+	// ڵչʧܵԤԻۼӵ_usedϣض
+	result.treeNodes = min(_used.load(), _capacity);
+	result.elapsedMs = (uint64_t)chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+	for (int i = 0; i < threadCount; i++)
+	{
+		result.playouts += result.threadPlayouts[i];
+		result.threadPps[i] = result.elapsedMs > 0 ? result.threadPlayouts[i] * 1000 / result.elapsedMs : result.threadPlayouts[i];
+	}
+	return true;
+}
+
+//չȡǰΧһĿλֱǰMaxChildren
+//ڵز߳չʱ-1
+int ChessMcts::expand(Worker &w, int nodeIndex)
+{
+	Node &node = _nodes[nodeIndex];
+	uint8_t expected = 0;
+	if (!node.expanding.compare_exchange_strong(expected, 1))
+		return -1;
+
+	const char me = (w.path.size() % 2 == 1) ? w.rootPlayer : (w.rootPlayer == '1' ? '2' : '1');
+	const char opp = me == '1' ? '2' : '1';
+	if (++w.stampGen == 0)
+	{
+		fill(w.stamp.begin(), w.stamp.end(), 0);
+		w.stampGen = 1;
+	}
+	w.scored.clear();
+	for (size_t i = 0; i < w.stones.size(); i++)
+	{
+		for (int k = 0; k < 26; k++)
+		{
+			int64_t c = w.stones[i] + _neighbors[k];
+			if (w.board[c] != 0 || w.stamp[c] == w.stampGen)
+				continue;
+			w.stamp[c] = w.stampGen;
+			// ֣뼺/Էĳ
+			int score = 0;
+			for (int d = 0; d < ChessDirectionCount; d++)
+			{
+				const int64_t s = _strides[d];
+				int mine = 0, theirs = 0;
+				for (int64_t p = c + s; w.board[p] == me && mine < 4; p += s)
+					mine++;
+				for (int64_t p = c - s; w.board[p] == me && mine < 4; p -= s)
+					mine++;
+				for (int64_t p = c + s; w.board[p] == opp && theirs < 4; p += s)
+					theirs++;
+				for (int64_t p = c - s; w.board[p] == opp && theirs < 4; p -= s)
+					theirs++;
+				score += (mine >= 4 ? 100000 : mine * mine * 4) + (theirs >= 4 ? 50000 : theirs * theirs * 3);
+			}
+			w.scored.push_back(make_pair(score, c));
+		}
+	}
+	if (w.scored.empty())
+		return -1;
+	size_t keep = min(w.scored.size(), (size_t)MaxChildren);
+	partial_sort(w.scored.begin(), w.scored.begin() + keep, w.scored.end(), [](const pair<int, int64_t> &a,
+	             const pair<int, int64_t> &b)
+	{
+		return a.first > b.first;
+	});
+
+	if (_used.load(memory_order_relaxed) + keep > _capacity)
+		return -1;
+	size_t first = _used.fetch_add(keep);
+	if (first + keep > _capacity)
+		return -1;
+	for (size_t i = 0; i < keep; i++)
+	{
+		Node &child = _nodes[first + i];
+		child.visits.store(0, memory_order_relaxed);
+		child.score.store(0, memory_order_relaxed);
+		child.firstChild.store(-1, memory_order_relaxed);
+		child.expanding.store(0, memory_order_relaxed);
+		child.childCount = 0;
+		child.move = (int32_t)w.scored[i].second;
+		w.board[child.move] = me;
+		child.terminal = isFive(w.board.data(), child.move, me);
+		w.board[child.move] = 0;
+	}
+	node.childCount = (int32_t)keep;
+	node.firstChild.store((int32_t)first, memory_order_release);
+	return (int)first;
+}
+
+//̷ִ߳Уѡ񣨴ʧ-> չ -> ģ -> ش
+void ChessMcts::runWorker(Worker &w, uint64_t maxPlayouts, chrono::steady_clock::time_point deadline, bool hasDeadline)
+{
+	while (!_stop.load(memory_order_relaxed))
+	{
+		if (maxPlayouts > 0 && _playouts.load(memory_order_relaxed) >= maxPlayouts)
+			break;
+		if (hasDeadline && (w.playouts & 15) == 0 && chrono::steady_clock::now() >= deadline)
+			break;
+
+		w.path.assign(1, 0);
+		_nodes[0].visits.fetch_add(1, memory_order_relaxed);
+		char side = w.rootPlayer;
+		char winner = 0;
+		bool finished = false;
+		int32_t current = 0;
+		while (true)
+		{
+			Node &node = _nodes[current];
+			int32_t first = node.firstChild.load(memory_order_acquire);
+			if (first < 0)
+			{
+				if (node.visits.load(memory_order_relaxed) < ExpandVisits && current != 0)
+					break;
+				first = expand(w, current);
+				if (first < 0)
+					break;
+			}
+			// UCTѡӽڵ㣻ʧȼ1÷ݲӣڱ̽ķ֧Եø
+			const double logParent = log((double)node.visits.load(memory_order_relaxed) + 1.0);
+			int32_t best = first;
+			double bestValue = -1.0;
+			for (int32_t i = 0; i < node.childCount; i++)
+			{
+				const Node &child = _nodes[first + i];
+				int32_t v = child.visits.load(memory_order_relaxed);
+				if (v == 0)
+				{
+					best = first + i;
+					break;
+				}
+				double value = child.score.load(memory_order_relaxed) / (2.0 * v) + Exploration * sqrt(logParent / v);
+				if (value > bestValue)
+				{
+					bestValue = value;
+					best = first + i;
+				}
+			}
+			Node &child = _nodes[best];
+			child.visits.fetch_add(1, memory_order_relaxed);
+			w.board[child.move] = side;
+			w.stones.push_back(child.move);
+			w.path.push_back(best);
+			current = best;
+			if (child.terminal)
+			{
+				winner = side;
+				finished = true;
+				break;
+			}
+			side = side == '1' ? '2' : '1';
+		}
+
+		double result;//ԸӷrootPlayerӽ
+		if (finished)
+			result = winner == w.rootPlayer ? 1.0 : 0.0;
+		else
+			result = playout(w);
+
+		// شpath[i]ӷiΪʱrootPlayer
+		for (size_t i = 1; i < w.path.size(); i++)
+		{
+			double s = (i % 2 == 1) ? result : 1.0 - result;
+			_nodes[w.path[i]].score.fetch_add((int64_t)(s * 2.0 + 0.5), memory_order_relaxed);
+		}
+
+		for (size_t i = w.rootStones; i < w.stones.size(); i++)
+			w.board[w.stones[i]] = 0;
+		w.stones.resize(w.rootStones);
+		w.playouts++;
+		_playouts.fetch_add(1, memory_order_relaxed);
+	}
+}
+
+//ģ⣺ÿȡһӵڸʧ򰴺ظӷ÷
+double ChessMcts::playout(Worker &w)
+{
+	char side = (w.path.size() % 2 == 1) ? w.rootPlayer : (w.rootPlayer == '1' ? '2' : '1');
+	const size_t cells = (size_t)_boardSize * _boardSize * _boardSize;
+	for (int step = 0; step < _maxPlayoutMoves && w.stones.size() < cells; step++)
+	{
+		int64_t move = -1;
+		for (int attempt = 0; attempt < 16; attempt++)
+		{
+			uint64_t r = w.next();
+			int64_t c = w.stones[(size_t)(r % w.stones.size())] + _neighbors[(r >> 32) % 26];
+			if (w.board[c] == 0)
+			{
+				move = c;
+				break;
+			}
+		}
+		if (move < 0)
+			break;
+		w.board[move] = side;
+		w.stones.push_back(move);
+		if (isFive(w.board.data(), move, side))
+			return side == w.rootPlayer ? 1.0 : 0.0;
+		side = side == '1' ? '2' : '1';
+	}
+	return 0.5;
+}
@@ -0,0 +1,107 @@
+#include <cstdint>
+#include "../include/chess-mmap.h"
+#include "../include/chess-log.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+ChessMappedFile::ChessMappedFile()
+{
+}
+
+ChessMappedFile::~ChessMappedFile()
+{
+	close();
+}
+
+bool ChessMappedFile::open(const char *path, bool writable, ChessMapAccess access)
+{
+	close();
+	_writable = writable;
+#ifdef _WIN32
+	DWORD flags = access == ChessMapSequential ? FILE_FLAG_SEQUENTIAL_SCAN :
+	              access == ChessMapRandom ? FILE_FLAG_RANDOM_ACCESS : FILE_ATTRIBUTE_NORMAL;
+	HANDLE file = CreateFileA(path, writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+	                          nullptr, OPEN_EXISTING, flags, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || (uint64_t)size.QuadPart > (uint64_t)SIZE_MAX)
+	{
+		CloseHandle(file);
+		return false;
+	}
+	_file = file;
+	_size = (uint64_t)size.QuadPart;
+	if (_size == 0)
+		return true;
+	HANDLE mapping = CreateFileMappingA(file, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr)
+	{
+		close();
+		return false;
+	}
+	_mapping = mapping;
+	_data = (uint8_t *)MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0);
+#else
+	int fd = ::open(path, writable ? O_RDWR : O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat st;
+	if (fstat(fd, &st) != 0)
+	{
+		::close(fd);
+		return false;
+	}
+	_size = (uint64_t)st.st_size;
+	if (_size == 0)
+	{
+		::close(fd);
+		return true;
+	}
+	void *p = mmap(nullptr, (size_t)_size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (p != MAP_FAILED)
+	{
+		if (access != ChessMapNormal)
+			madvise(p, (size_t)_size, access == ChessMapSequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+		_data = (uint8_t *)p;
+	}
+#endif
+	if (_data == nullptr)
+	{
+		CHESS_LOG_ERROR("ERROR mapping file %s", path);
+		close();
+		return false;
+	}
+	return true;
+}
+
+void ChessMappedFile::close()
+{
+#ifdef _WIN32
+	if (_data)
+		UnmapViewOfFile(_data);
+	if (_mapping)
+		CloseHandle((HANDLE)_mapping);
+	if (_file)
+		CloseHandle((HANDLE)_file);
+#else
+	if (_data)
+		munmap(_data, (size_t)_size);
+#endif
+	_data = nullptr;
+	_size = 0;
+	_writable = false;
+	_file = nullptr;
+	_mapping = nullptr;
+}
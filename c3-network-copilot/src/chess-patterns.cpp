@@ -0,0 +1,234 @@
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include "../include/chess-patterns.h"
+using namespace std;
+
+const char *const ChessPatternNames[ChessPatternCount] =
+{
+	"open-two", "open-three", "four", "broken-four", "open-four", "five"
+};
+
+//ηֵPatternEvalScore
+static const int PatternWeights[ChessPatternCount] = { 10, 120, 150, 150, 5000, 100000 };
+
+static unique_ptr<ChessRayTable> BuildChessRayTable(int BoardSize)
+{
+	unique_ptr<ChessRayTable> t(new ChessRayTable());
+	const int N = BoardSize;
+	t->boardSize = N;
+	t->cellRays.assign((size_t)N * N * N * ChessDirectionCount, -1);
+	for (int d = 0; d < ChessDirectionCount; d++)
+	{
+		int dx = ChessDirections[d][0], dy = ChessDirections[d][1], dz = ChessDirections[d][2];
+		int stride = dx + dy * N + dz * N * N;
+		for (int z = 1; z <= N; z++)
+		{
+			for (int y = 1; y <= N; y++)
+			{
+				for (int x = 1; x <= N; x++)
+				{
+					// ֱֻߵĵһӳһ磩
+					int px = x - dx, py = y - dy, pz = z - dz;
+					if (px >= 1 && px <= N && py >= 1 && py <= N && pz >= 1 && pz <= N)
+						continue;
+					int length = 0;
+					for (int cx = x, cy = y, cz = z; cx >= 1 && cx <= N && cy >= 1 && cy <= N && cz >= 1 && cz <= N;
+					        cx += dx, cy += dy, cz += dz)
+						length++;
+					if (length < 5)
+						continue;
+					int ray = t->rayCount++;
+					int start = place(x, y, z, N);
+					t->rayStart.push_back(start);
+					t->rayStride.push_back(stride);
+					t->rayLength.push_back((uint8_t)length);
+					for (int k = 0; k < length; k++)
+						t->cellRays[(size_t)(start + k * stride) * ChessDirectionCount + d] = ray;
+				}
+			}
+		}
+	}
+	return t;
+}
+
+const ChessRayTable *GetChessRayTable(int BoardSize)
+{
+	if (BoardSize < 1 || BoardSize > ChessLineTableMaxSize)
+		return nullptr;
+	static mutex tablesMutex;
+	static map<int, unique_ptr<ChessRayTable>> tables;
+	lock_guard<mutex> lk(tablesMutex);
+	unique_ptr<ChessRayTable> &slot = tables[BoardSize];
+	if (!slot)
+		slot = BuildChessRayTable(BoardSize);
+	return slot.get();
+}
+
+//һӹࣺ֮һλlf/rfΪ˽ڵλ
+static int ClassifyGroup(int stones, int gaps, int longest, int lf, int rf)
+{
+	if (longest >= 5)
+		return PatternFive;
+	if (stones >= 5)
+		return PatternBrokenFour;
+	if (stones == 4)
+	{
+		if (gaps == 0)
+		{
+			if (lf >= 1 && rf >= 1)
+				return PatternOpenFour;
+			return (lf >= 1 || rf >= 1) ? PatternFour : -1;
+		}
+		if (gaps == 1)
+			return PatternBrokenFour;
+		return (lf >= 1 && rf >= 1) ? PatternOpenThree : -1;
+	}
+	if (stones == 3)
+	{
+		if (gaps == 0)
+			return (lf >= 1 && rf >= 1 && lf + rf >= 3) ? PatternOpenThree : -1;
+		if (gaps == 1)
+			return (lf >= 1 && rf >= 1) ? PatternOpenThree : -1;
+		return -1;
+	}
+	if (stones == 2)
+	{
+		if (gaps == 0)
+			return (lf >= 1 && rf >= 1 && lf + rf >= 4) ? PatternOpenTwo : -1;
+		if (gaps == 1)
+			return (lf >= 1 && rf >= 1 && lf + rf >= 3) ? PatternOpenTwo : -1;
+	}
+	return -1;
+}
+
+//ɨһֱĳһΣȰԷгɶΣ5Ķ޷壬ٷ
+static void ScanLine(const uint8_t *line, int length, int plane, uint8_t out[ChessPatternCount])
+{
+	memset(out, 0, ChessPatternCount);
+	const uint8_t me = (uint8_t)(plane + 1);
+	int segStart = 0;
+	while (segStart < length)
+	{
+		int segEnd = segStart;
+		while (segEnd < length && (line[segEnd] == 0 || line[segEnd] == me))
+			segEnd++;
+		if (segEnd - segStart >= 5)
+		{
+			int i = segStart;
+			while (i < segEnd)
+			{
+				if (line[i] != me)
+				{
+					i++;
+					continue;
+				}
+				// 飺iʼǰһӵļһλ
+				int first = i, last = i, stones = 1, run = 1, longest = 1;
+				int j = i + 1;
+				while (j < segEnd)
+				{
+					if (line[j] == me)
+					{
+						stones++;
+						run = (j == last + 1) ? run + 1 : 1;
+						longest = max(longest, run);
+						last = j;
+						j++;
+					}
+					else if (j + 1 < segEnd && j == last + 1 && line[j + 1] == me)
+					{
+						j++;
+					}
+					else
+					{
+						break;
+					}
+				}
+				int lf = 0, rf = 0;
+				for (int k = first - 1; k >= segStart && line[k] == 0; k--)
+					lf++;
+				for (int k = last + 1; k < segEnd && line[k] == 0; k++)
+					rf++;
+				int gaps = (last - first + 1) - stones;
+				int kind = ClassifyGroup(stones, gaps, longest, lf, rf);
+				if (kind >= 0 && out[kind] < 255)
+					out[kind]++;
+				i = last + 1;
+			}
+		}
+		segStart = segEnd + 1;
+	}
+}
+
+//ɨ辭cell13ֱߣ¼滻
+static void RescanCell(ChessPatternEval &eval, int cell)
+{
+	const ChessRayTable &t = *eval.table;
+	for (int d = 0; d < ChessDirectionCount; d++)
+	{
+		int ray = t.cellRays[(size_t)cell * ChessDirectionCount + d];
+		if (ray < 0)
+			continue;
+		const int length = t.rayLength[ray], stride = t.rayStride[ray];
+		const uint8_t *start = &eval.board[t.rayStart[ray]];
+		uint8_t line[ChessLineTableMaxSize];
+		for (int i = 0; i < length; i++)
+			line[i] = start[(ptrdiff_t)i * stride];
+		for (int p = 0; p < 2; p++)
+		{
+			uint8_t *cached = &eval.rayCounts[((size_t)ray * 2 + p) * ChessPatternCount];
+			uint8_t fresh[ChessPatternCount];
+			ScanLine(line, length, p, fresh);
+			for (int k = 0; k < ChessPatternCount; k++)
+			{
+				eval.counts[p][k] += (int)fresh[k] - (int)cached[k];
+				cached[k] = fresh[k];
+			}
+		}
+	}
+}
+
+bool InitPatternEval(ChessPatternEval *pEval, int BoardSize)
+{
+	pEval->table = GetChessRayTable(BoardSize);
+	if (pEval->table == nullptr)
+	{
+		FreePatternEval(pEval);
+		return false;
+	}
+	pEval->board.assign((size_t)BoardSize * BoardSize * BoardSize, 0);
+	pEval->rayCounts.assign((size_t)pEval->table->rayCount * 2 * ChessPatternCount, 0);
+	memset(pEval->counts, 0, sizeof(pEval->counts));
+	return true;
+}
+
+void FreePatternEval(ChessPatternEval *pEval)
+{
+	pEval->table = nullptr;
+	vector<uint8_t>().swap(pEval->board);
+	vector<uint8_t>().swap(pEval->rayCounts);
+	memset(pEval->counts, 0, sizeof(pEval->counts));
+}
+
+void PatternEvalPlace(ChessPatternEval &eval, int cell, int plane)
+{
+	eval.board[cell] = (uint8_t)(plane + 1);
+	RescanCell(eval, cell);
+}
+
+void PatternEvalRemove(ChessPatternEval &eval, int cell)
+{
+	eval.board[cell] = 0;
+	RescanCell(eval, cell);
+}
+
+int PatternEvalScore(const ChessPatternEval &eval, int plane)
+{
+	int score = 0;
+	for (int k = 0; k < ChessPatternCount; k++)
+		score += PatternWeights[k] * (eval.counts[plane][k] - eval.counts[plane ^ 1][k]);
+	return score;
+}
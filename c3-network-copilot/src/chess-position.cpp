@@ -0,0 +1,133 @@
+#include <cstring>
+#include "../include/chess-position.h"
+#include "../include/chess-log.h"
+#include "../include/chess-zobrist.h"
+using namespace std;
+
+bool InitPosition(ChessPosition *pPosition, int BoardSize, int candidateRadius, int track)
+{
+	FreePosition(pPosition);
+	if (!InitLineCounters(&pPosition->lines, BoardSize))
+	{
+		CHESS_LOG_ERROR("ERROR allocating position: board size %d exceeds %d", BoardSize, (int)ChessLineTableMaxSize);
+		return false;
+	}
+	if (!InitCandidates(&pPosition->candidates, BoardSize, candidateRadius) ||
+	        ((track & PositionTrackPatterns) && !InitPatternEval(&pPosition->patterns, BoardSize)))
+	{
+		FreePosition(pPosition);
+		return false;
+	}
+	pPosition->boardSize = BoardSize;
+	pPosition->cells = BoardSize * BoardSize * BoardSize;
+	pPosition->board.assign(pPosition->cells, 0);
+	pPosition->track = track;
+	pPosition->keys = GetChessZobristKeys(BoardSize);
+	pPosition->hash = 0;
+	pPosition->symmetry = (track & PositionTrackSymmetry) ? GetChessSymmetryTable(BoardSize) : nullptr;
+	pPosition->symmetricHash = ChessSymmetricHash();
+	pPosition->side = 0;
+	pPosition->fives = 0;
+	pPosition->loaded = 0;
+	pPosition->moves.clear();
+	pPosition->moves.reserve(pPosition->cells);
+	return true;
+}
+
+void FreePosition(ChessPosition *pPosition)
+{
+	FreeLineCounters(&pPosition->lines);
+	FreeCandidates(&pPosition->candidates);
+	FreePatternEval(&pPosition->patterns);
+	vector<char>().swap(pPosition->board);
+	vector<ChessPositionMove>().swap(pPosition->moves);
+	pPosition->boardSize = pPosition->cells = 0;
+	pPosition->track = 0;
+	pPosition->keys = nullptr;
+	pPosition->hash = 0;
+	pPosition->symmetry = nullptr;
+	pPosition->symmetricHash = ChessSymmetricHash();
+	pPosition->side = 0;
+	pPosition->fives = 0;
+	pPosition->loaded = 0;
+}
+
+bool PositionMakeAs(ChessPosition &position, int cell, int plane)
+{
+	position.board[cell] = (char)(plane + 1);
+	bool five = LineCountersPlace(position.lines, cell, plane);
+	CandidatesPlace(position.candidates, cell);
+	if (position.track & PositionTrackPatterns)
+		PatternEvalPlace(position.patterns, cell, plane);
+	position.hash ^= position.keys[(size_t)cell * 2 + plane];
+	if (position.symmetry)
+		SymmetricHashToggle(position.symmetricHash, position.symmetry, position.cells, position.keys, cell, plane);
+	position.side = plane ^ 1;
+	position.fives += five;
+	ChessPositionMove m = { cell, (uint8_t)plane, five };
+	position.moves.push_back(m);
+	return five;
+}
+
+bool PositionMake(ChessPosition &position, int cell)
+{
+	return PositionMakeAs(position, cell, position.side);
+}
+
+//PositionMakeAsϸ
+bool PositionUnmake(ChessPosition &position)
+{
+	if ((int)position.moves.size() <= position.loaded)
+		return false;
+	const ChessPositionMove m = position.moves.back();
+	position.moves.pop_back();
+	position.fives -= m.five;
+	position.side = m.plane;
+	position.hash ^= position.keys[(size_t)m.cell * 2 + m.plane];
+	if (position.symmetry)
+		SymmetricHashToggle(position.symmetricHash, position.symmetry, position.cells, position.keys, m.cell, m.plane);
+	if (position.track & PositionTrackPatterns)
+		PatternEvalRemove(position.patterns, m.cell);
+	CandidatesRemove(position.candidates, m.cell);
+	LineCountersRemove(position.lines, m.cell, m.plane);
+	position.board[m.cell] = 0;
+	return true;
+}
+
+void PositionRewind(ChessPosition &position, int ply)
+{
+	while (PositionPly(position) > ply && PositionUnmake(position))
+		;
+}
+
+bool PositionLoad(ChessPosition &position, const char *ChessBoard, int side)
+{
+	position.loaded = 0;
+	PositionRewind(position, 0);
+	for (int c = 0; c < position.cells; c++)
+	{
+		char v = ChessBoard[c];
+		if (v == 0)
+			continue;
+		if (v != '1' && v != '2')
+		{
+			PositionRewind(position, 0);
+			return false;
+		}
+		PositionMakeAs(position, c, v == '2' ? 1 : 0);
+	}
+	position.loaded = (int)position.moves.size();
+	position.side = side;
+	return true;
+}
+
+uint64_t PositionCanonicalHash(const ChessPosition &position, int *pSym)
+{
+	if (position.symmetry == nullptr)
+	{
+		if (pSym)
+			*pSym = 0;
+		return position.hash;
+	}
+	return SymmetricHashCanonical(position.symmetricHash, pSym);
+}
@@ -0,0 +1,71 @@
+#include <cstdio>
+#include <cstdlib>
+#include "../include/chess-record.h"
+#include "../include/chess-log.h"
+using namespace std;
+
+uint64_t ChessRecordParseId(const string &id)
+{
+	if (id.empty() || id.size() > 16)
+		return 0;
+	uint64_t v = 0;
+	for (char ch : id)
+	{
+		int d;
+		if (ch >= '0' && ch <= '9')
+			d = ch - '0';
+		else if (ch >= 'a' && ch <= 'f')
+			d = ch - 'a' + 10;
+		else if (ch >= 'A' && ch <= 'F')
+			d = ch - 'A' + 10;
+		else
+			return 0;
+		v = v << 4 | (uint64_t)d;
+	}
+	return v;
+}
+
+string ChessRecordFormatId(uint64_t id)
+{
+	char buf[17];
+	snprintf(buf, sizeof(buf), "%016llx", (unsigned long long)id);
+	return string(buf);
+}
+
+bool AppendChessRecord(const char *path, ChessRecordHeader header, const ChessRecordMove *moves)
+{
+	header.magic = ChessRecordMagic;
+	header.version = ChessRecordVersion;
+	header.headerBytes = (uint16_t)sizeof(ChessRecordHeader);
+	FILE *f = fopen(path, "ab");
+	if (!f)
+	{
+		CHESS_LOG_ERROR("ERROR opening game record file %s", path);
+		return false;
+	}
+	// һд꣬ʱļβһļ¼ȡʱԣ
+	bool ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+	          (header.moveCount == 0 || fwrite(moves, sizeof(ChessRecordMove), header.moveCount, f) == header.moveCount);
+	ok = fclose(f) == 0 && ok;
+	if (!ok)
+		CHESS_LOG_ERROR("ERROR writing game record file %s", path);
+	return ok;
+}
+
+bool ChessRecordArchive::next(uint64_t &offset, const ChessRecordHeader *&header, const ChessRecordMove *&moves) const
+{
+	const uint8_t *data = _file.data();
+	const uint64_t size = _file.size();
+	if (data == nullptr || offset + sizeof(ChessRecordHeader) > size)
+		return false;
+	const ChessRecordHeader *h = (const ChessRecordHeader *)(data + offset);
+	if (h->magic != ChessRecordMagic || h->headerBytes < sizeof(ChessRecordHeader) || h->headerBytes % 8 != 0)
+		return false;
+	uint64_t end = offset + h->headerBytes + (uint64_t)h->moveCount * sizeof(ChessRecordMove);
+	if (end > size)
+		return false;
+	header = h;
+	moves = (const ChessRecordMove *)(data + offset + h->headerBytes);
+	offset = end;
+	return true;
+}
@@ -0,0 +1,75 @@
+#include "../include/chess-log.h"
+#include "../include/chess-rules.h"
+using namespace std;
+
+int ChessRulesDynamic::winDirection(const char *ChessBoard, int x, int y, int z, char player) const
+{
+	const int center = index(x, y, z);
+	for (int d = 0; d < ChessDirectionCount; d++)
+	{
+		const int dx = ChessDirections[d][0], dy = ChessDirections[d][1], dz = ChessDirections[d][2];
+		const int step = stride(d);
+		int run = 1;
+		for (int k = 1; k < win && inside(x + k * dx, y + k * dy, z + k * dz) && ChessBoard[center + k * step] == player; k++)
+			run++;
+		for (int k = 1; k < win && run < win && inside(x - k * dx, y - k * dy, z - k * dz)
+		        && ChessBoard[center - k * step] == player; k++)
+			run++;
+		if (run >= win)
+			return d;
+	}
+	return -1;
+}
+
+template <class Rules>
+static int RuleSetWinDirection(const ChessRuleSet &, const char *ChessBoard, int x, int y, int z, char player)
+{
+	return Rules::winDirection(ChessBoard, x, y, z, player);
+}
+
+static int DynamicWinDirection(const ChessRuleSet &rules, const char *ChessBoard, int x, int y, int z, char player)
+{
+	return ChessRulesDynamic(rules.boardSize, rules.winLength).winDirection(ChessBoard, x, y, z, player);
+}
+
+struct AssignRuleSet
+{
+	ChessRuleSet *pRules;
+
+	template <int Size, int WinLength>
+	void operator()(ChessRules<Size, WinLength>) const
+	{
+		pRules->specialized = true;
+		pRules->winDirection = &RuleSetWinDirection<ChessRules<Size, WinLength>>;
+	}
+	void operator()(const ChessRulesDynamic &) const
+	{
+		pRules->specialized = false;
+		pRules->winDirection = &DynamicWinDirection;
+	}
+};
+
+bool GetChessRuleSet(int BoardSize, int WinLength, ChessRuleSet *pRules)
+{
+	if (BoardSize < 1 || WinLength < 2 || WinLength > 32)
+	{
+		CHESS_LOG_ERROR("ERROR: unsupported rules %d^3 / %d in a row", BoardSize, WinLength);
+		return false;
+	}
+	pRules->boardSize = BoardSize;
+	pRules->winLength = WinLength;
+	AssignRuleSet assign = { pRules };
+	DispatchChessRules(BoardSize, WinLength, assign);
+	return true;
+}
+
+int CheckWinRules(const ChessRuleSet &rules, const char *ChessBoard, int input[], char player)
+{
+	int dir = rules.winDirection(rules, ChessBoard, input[0], input[1], input[2], player);
+	if (dir >= 0)
+	{
+		CHESS_LOG_INFO("The player%c wins! In the %s direction", player, ChessDirectionNames[dir]);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,145 @@
+#include <cstdio>
+#include "../include/chess-log.h"
+#include "../include/chess-sparse.h"
+using namespace std;
+
+//ʼ2ݣװʳ1/2ʱ
+static const size_t SparseInitialSlots = 64;
+
+static inline size_t SparseSlot(uint64_t key, size_t mask)
+{
+	// FibonacciɢУڸӵҲܾȷֲ
+	return (size_t)((key * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+}
+
+static void SparseInsert(vector<uint64_t> &keys, vector<char> &values, uint64_t key, char value)
+{
+	const size_t mask = keys.size() - 1;
+	size_t slot = SparseSlot(key, mask);
+	while (keys[slot] != 0)
+		slot = (slot + 1) & mask;
+	keys[slot] = key;
+	values[slot] = value;
+}
+
+static void SparseGrow(ChessSparseBoard &board)
+{
+	vector<uint64_t> keys(board.keys.size() * 2, 0);
+	vector<char> values(keys.size(), 0);
+	for (size_t i = 0; i < board.keys.size(); i++)
+	{
+		if (board.keys[i] != 0)
+			SparseInsert(keys, values, board.keys[i], board.values[i]);
+	}
+	board.keys.swap(keys);
+	board.values.swap(values);
+}
+
+static char SparseLookup(const ChessSparseBoard &board, int64_t index)
+{
+	const uint64_t key = (uint64_t)index + 1;
+	const size_t mask = board.keys.size() - 1;
+	for (size_t slot = SparseSlot(key, mask); board.keys[slot] != 0; slot = (slot + 1) & mask)
+	{
+		if (board.keys[slot] == key)
+			return board.values[slot];
+	}
+	return 0;
+}
+
+int64_t SparseBoardIndex(const ChessSparseBoard &board, int x, int y, int z)
+{
+	const int64_t N = board.boardSize;
+	return (x - 1) + (y - 1) * N + (z - 1) * N * N;
+}
+
+bool OnlineInitSparseBoard(ChessSparseBoard *pBoard, int BoardSize)
+{
+	if (BoardSize < 1)
+	{
+		CHESS_LOG_ERROR("ERROR allocating online sparse board!");
+		return false;
+	}
+	pBoard->boardSize = BoardSize;
+	pBoard->stones = 0;
+	pBoard->keys.assign(SparseInitialSlots, 0);
+	pBoard->values.assign(SparseInitialSlots, 0);
+	return true;
+}
+
+void FreeSparseBoard(ChessSparseBoard *pBoard)
+{
+	vector<uint64_t>().swap(pBoard->keys);
+	vector<char>().swap(pBoard->values);
+	pBoard->stones = 0;
+	pBoard->boardSize = 0;
+}
+
+char SparseBoardAt(const ChessSparseBoard &board, int x, int y, int z)
+{
+	return SparseLookup(board, SparseBoardIndex(board, x, y, z));
+}
+
+//UpdateBoardStateͬĺϷԼֻдϣ
+bool UpdateSparseBoardState(ChessSparseBoard &board, int input[], char player)
+{
+	int BoardSize = board.boardSize;
+	if (input[0] < 1 || input[0] > BoardSize || input[1] < 1 || input[1] > BoardSize || input[2] < 1
+	        || input[2] > BoardSize)
+	{
+		CHESS_LOG_INFO("INVALID_MOVE: Position is out of the board range.");
+		return false;
+	}
+
+	int64_t index = SparseBoardIndex(board, input[0], input[1], input[2]);
+	if (SparseLookup(board, index) != 0)
+	{
+		CHESS_LOG_INFO("INVALID_MOVE: A chess piece already exists at this position.");
+		return false;
+	}
+
+	if ((board.stones + 1) * 2 > board.keys.size())
+		SparseGrow(board);
+	SparseInsert(board.keys, board.values, (uint64_t)index + 1, player);
+	board.stones++;
+	CHESS_LOG_DEBUG("MOVE_ACCEPTED: Board updated. Player %c placed a piece at (%d, %d, %d).", player, input[0], input[1], input[2]);
+	return true;
+}
+
+int CheckWinSparseBoard(const ChessSparseBoard &board, int input[], char player)
+{
+	int dir = SparseBoardWinDirection(board, input[0], input[1], input[2], player);
+	if (dir >= 0)
+	{
+		CHESS_LOG_INFO("The player%c wins! In the %s direction", player, ChessDirectionNames[dir]);
+		return 1;
+	}
+	return 0;
+}
+
+//CheckWinͬ13ȡӵΪĵ9λڽFindFiveDirection
+//ĸӲֱӵλ
+int SparseBoardWinDirection(const ChessSparseBoard &board, int x, int y, int z, char player)
+{
+	const int N = board.boardSize;
+	uint32_t windows[ChessDirectionCount];
+	for (int d = 0; d < ChessDirectionCount; d++)
+	{
+		int dx = ChessDirections[d][0], dy = ChessDirections[d][1], dz = ChessDirections[d][2];
+		int cx = x - 4 * dx, cy = y - 4 * dy, cz = z - 4 * dz;
+		uint32_t w = 0;
+		for (int k = 0; k < 9; k++, cx += dx, cy += dy, cz += dz)
+		{
+			if (cx >= 1 && cx <= N && cy >= 1 && cy <= N && cz >= 1 && cz <= N
+			        && SparseLookup(board, SparseBoardIndex(board, cx, cy, cz)) == player)
+				w |= 1u << k;
+		}
+		windows[d] = w;
+	}
+	return FindFiveDirection(windows);
+}
+
+size_t SparseBoardBytes(const ChessSparseBoard &board)
+{
+	return board.keys.capacity() * sizeof(uint64_t) + board.values.capacity() * sizeof(char);
+}
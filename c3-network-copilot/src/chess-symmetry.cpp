@@ -0,0 +1,125 @@
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "../include/chess-symmetry.h"
+#include "../include/chess-lines.h"
+#include "../include/chess-zobrist.h"
+using namespace std;
+
+//6û
+static const int ChessSymmetryAxes[6][3] =
+{
+	{ 0, 1, 2 }, { 0, 2, 1 }, { 1, 0, 2 }, { 1, 2, 0 }, { 2, 0, 1 }, { 2, 1, 0 }
+};
+
+//0ʼ
+static inline void MapCoords(const int in[3], int sym, int BoardSize, int out[3])
+{
+	const int *axes = ChessSymmetryAxes[sym / 8];
+	const int flips = sym % 8;
+	for (int i = 0; i < 3; i++)
+	{
+		int v = in[axes[i]];
+		out[i] = (flips >> i & 1) ? BoardSize - 1 - v : v;
+	}
+}
+
+//out[i] = f_i(in[axes[i]])  =>  in[j] = f_k(out[k])axes[k] = j
+int SymmetryInverse(int sym)
+{
+	const int *axes = ChessSymmetryAxes[sym / 8];
+	const int flips = sym % 8;
+	int inverseAxes[3], inverseFlips = 0;
+	for (int k = 0; k < 3; k++)
+	{
+		inverseAxes[axes[k]] = k;
+		if (flips >> k & 1)
+			inverseFlips |= 1 << axes[k];
+	}
+	for (int p = 0; p < 6; p++)
+	{
+		if (ChessSymmetryAxes[p][0] == inverseAxes[0] && ChessSymmetryAxes[p][1] == inverseAxes[1] &&
+		        ChessSymmetryAxes[p][2] == inverseAxes[2])
+			return p * 8 + inverseFlips;
+	}
+	return 0;
+}
+
+int SymmetryMapCell(int cell, int sym, int BoardSize)
+{
+	const int N = BoardSize;
+	int in[3] = { cell % N, cell / N % N, cell / (N * N) }, out[3];
+	MapCoords(in, sym, N, out);
+	return out[0] + out[1] * N + out[2] * N * N;
+}
+
+void SymmetryMapMove(const int input[3], int sym, int BoardSize, int output[3])
+{
+	int in[3] = { input[0] - 1, input[1] - 1, input[2] - 1 };
+	MapCoords(in, sym, BoardSize, output);
+	for (int i = 0; i < 3; i++)
+		output[i]++;
+}
+
+const int32_t *GetChessSymmetryTable(int BoardSize)
+{
+	if (BoardSize < 1 || BoardSize > ChessLineTableMaxSize)
+		return nullptr;
+	static mutex tablesMutex;
+	static map<int, unique_ptr<vector<int32_t>>> tables;
+	lock_guard<mutex> lk(tablesMutex);
+	unique_ptr<vector<int32_t>> &slot = tables[BoardSize];
+	if (!slot)
+	{
+		const int cells = BoardSize * BoardSize * BoardSize;
+		slot.reset(new vector<int32_t>((size_t)ChessSymmetryCount * cells));
+		for (int s = 0; s < ChessSymmetryCount; s++)
+		{
+			for (int c = 0; c < cells; c++)
+				(*slot)[(size_t)s * cells + c] = SymmetryMapCell(c, s, BoardSize);
+		}
+	}
+	return slot->data();
+}
+
+uint64_t SymmetricHashCanonical(const ChessSymmetricHash &hash, int *pSym)
+{
+	int best = 0;
+	for (int s = 1; s < ChessSymmetryCount; s++)
+	{
+		if (hash.hashes[s] < hash.hashes[best])
+			best = s;
+	}
+	if (pSym)
+		*pSym = best;
+	return hash.hashes[best];
+}
+
+//ӳߴ
+uint64_t ChessCanonicalHash(const char *ChessBoard, int BoardSize, int *pSym)
+{
+	const uint64_t *keys = GetChessZobristKeys(BoardSize);
+	const int cells = BoardSize * BoardSize * BoardSize;
+	ChessSymmetricHash hash;
+	for (int c = 0; c < cells; c++)
+	{
+		if (ChessBoard[c] == 0)
+			continue;
+		const int plane = ChessBoard[c] == '2' ? 1 : 0;
+		for (int s = 0; s < ChessSymmetryCount; s++)
+			hash.hashes[s] ^= keys[(size_t)SymmetryMapCell(c, s, BoardSize) * 2 + plane];
+	}
+	return SymmetricHashCanonical(hash, pSym);
+}
+
+void CanonicalizeBoard(const char *ChessBoard, int BoardSize, char *output, int *pSym)
+{
+	int sym = 0;
+	ChessCanonicalHash(ChessBoard, BoardSize, &sym);
+	const int cells = BoardSize * BoardSize * BoardSize;
+	for (int c = 0; c < cells; c++)
+		output[SymmetryMapCell(c, sym, BoardSize)] = ChessBoard[c];
+	if (pSym)
+		*pSym = sym;
+}
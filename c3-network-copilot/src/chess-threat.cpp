@@ -0,0 +1,383 @@
+#include <algorithm>
+#include <chrono>
+#include <unordered_map>
+#include "../include/chess-threat.h"
+#include "../include/chess-game.h"
+#include "../include/chess-lines.h"
+#include "../include/chess-zobrist.h"
+using namespace std;
+
+namespace
+{
+	//״̸̬߼Լÿkӻߡĺѡб
+	//бֻʱ׷ӡʱضϣѯʱٰǰʧЧ
+	struct ThreatSolver
+	{
+		const ChessLineTable *table{ nullptr };
+		ChessLineCounters lines;
+		vector<char> board;                  //0ΪգΪ'1'/'2'
+		const uint64_t *keys{ nullptr };
+		uint64_t hash{ 0 };
+		vector<int32_t> live[2][5];          //live[p][k]pkҶԷӵߣk=2,3,4
+		vector<uint32_t> stamp;
+		uint32_t stampGen{ 0 };
+		vector<uint8_t> tally;
+		vector<int32_t> touched;
+
+		int attacker{ 0 };
+		int defender{ 1 };
+		uint64_t nodes{ 0 };
+		uint64_t maxNodes{ 0 };
+		int maxDepth{ 0 };
+		bool useThrees{ false };
+		bool aborted{ false };
+		uint64_t depthCuts{ 0 };
+		unordered_map<uint64_t, int32_t> cache;  //ľ棺ʤǵһ֣-1
+
+		struct Undo
+		{
+			int32_t cell;
+			int plane;
+			size_t sizes[3];
+		};
+		vector<Undo> undo;
+
+		uint32_t nextStamp()
+		{
+			if (++stampGen == 0)
+			{
+				fill(stamp.begin(), stamp.end(), 0);
+				stampGen = 1;
+			}
+			return stampGen;
+		}
+
+		bool isLive(int32_t line, int plane, int k) const
+		{
+			return lines.counts[(size_t)line * 2 + plane] == k && lines.counts[(size_t)line * 2 + (plane ^ 1)] == 0;
+		}
+
+		void play(int32_t cell, int plane)
+		{
+			Undo u;
+			u.cell = cell;
+			u.plane = plane;
+			for (int k = 2; k <= 4; k++)
+				u.sizes[k - 2] = live[plane][k].size();
+			undo.push_back(u);
+			board[cell] = plane ? '2' : '1';
+			hash ^= keys[(size_t)cell * 2 + plane];
+			LineCountersPlace(lines, cell, plane);
+			for (int32_t i = table->cellOffsets[cell]; i < table->cellOffsets[cell + 1]; i++)
+			{
+				int32_t line = table->cellLines[i];
+				int k = lines.counts[(size_t)line * 2 + plane];
+				if (k >= 2 && k <= 4 && lines.counts[(size_t)line * 2 + (plane ^ 1)] == 0)
+					live[plane][k].push_back(line);
+			}
+		}
+
+		void unplay()
+		{
+			const Undo &u = undo.back();
+			board[u.cell] = 0;
+			hash ^= keys[(size_t)u.cell * 2 + u.plane];
+			LineCountersRemove(lines, u.cell, u.plane);
+			for (int k = 2; k <= 4; k++)
+				live[u.plane][k].resize(u.sizes[k - 2]);
+			undo.pop_back();
+		}
+
+		//ռplanekӻϵĿλȥأlimit
+		void emptiesOf(int plane, int k, vector<int32_t> &out, size_t limit)
+		{
+			out.clear();
+			const uint32_t gen = nextStamp();
+			const vector<int32_t> &list = live[plane][k];
+			for (size_t i = 0; i < list.size() && out.size() < limit; i++)
+			{
+				if (!isLive(list[i], plane, k))
+					continue;
+				const int32_t *cells = &table->lineCells[(size_t)list[i] * 5];
+				for (int j = 0; j < 5; j++)
+				{
+					if (board[cells[j]] == 0 && stamp[cells[j]] != gen)
+					{
+						stamp[cells[j]] = gen;
+						out.push_back(cells[j]);
+					}
+				}
+			}
+		}
+
+		//Ӻγɵĳʵӣֻø3ӻߣ
+		int fourCount(int32_t cell, int plane)
+		{
+			int count = 0;
+			for (int32_t i = table->cellOffsets[cell]; i < table->cellOffsets[cell + 1]; i++)
+			{
+				if (isLive(table->cellLines[i], plane, 3))
+					count++;
+			}
+			return count;
+		}
+
+		//Ӻ󾭹ø3ӻԺ߳㣩
+		void threeMoves(int plane, vector<int32_t> &out)
+		{
+			out.clear();
+			const uint32_t gen = nextStamp();
+			const vector<int32_t> &list = live[plane][2];
+			touched.clear();
+			for (size_t i = 0; i < list.size(); i++)
+			{
+				if (!isLive(list[i], plane, 2))
+					continue;
+				const int32_t *cells = &table->lineCells[(size_t)list[i] * 5];
+				for (int j = 0; j < 5; j++)
+				{
+					int32_t c = cells[j];
+					if (board[c] != 0)
+						continue;
+					if (stamp[c] != gen)
+					{
+						stamp[c] = gen;
+						tally[c] = 0;
+						touched.push_back(c);
+					}
+					if (tally[c] < 255)
+						tally[c]++;
+				}
+			}
+			for (size_t i = 0; i < touched.size(); i++)
+			{
+				if (tally[touched[i]] >= 2)
+					out.push_back(touched[i]);
+			}
+		}
+
+		//ÿ㸴õĻвٷ
+		struct Ply
+		{
+			vector<int32_t> moves;
+			vector<int32_t> forced;
+			vector<int32_t> aux;
+			vector<pair<int, int32_t>> ordered;
+		};
+		vector<Ply> plies;
+
+		bool attack(int depth);
+		bool defend(int depth, int32_t move);
+		void replies(int32_t move, vector<int32_t> &out);
+	};
+
+	//طӦţгʱֻȥ£򣨻Զ¾3ӻߵĿλ߷
+	void ThreatSolver::replies(int32_t move, vector<int32_t> &out)
+	{
+		emptiesOf(attacker, 4, out, 2);
+		if (!out.empty())
+			return;
+		const uint32_t gen = nextStamp();
+		for (int32_t i = table->cellOffsets[move]; i < table->cellOffsets[move + 1]; i++)
+		{
+			int32_t line = table->cellLines[i];
+			if (!isLive(line, attacker, 3))
+				continue;
+			const int32_t *cells = &table->lineCells[(size_t)line * 5];
+			for (int j = 0; j < 5; j++)
+			{
+				if (board[cells[j]] == 0 && stamp[cells[j]] != gen)
+				{
+					stamp[cells[j]] = gen;
+					out.push_back(cells[j]);
+				}
+			}
+		}
+		const vector<int32_t> &list = live[defender][3];
+		for (size_t i = 0; i < list.size(); i++)
+		{
+			if (!isLive(list[i], defender, 3))
+				continue;
+			const int32_t *cells = &table->lineCells[(size_t)list[i] * 5];
+			for (int j = 0; j < 5; j++)
+			{
+				if (board[cells[j]] == 0 && stamp[cells[j]] != gen)
+				{
+					stamp[cells[j]] = gen;
+					out.push_back(cells[j]);
+				}
+			}
+		}
+	}
+
+	//壨ڵ㣩һвŷӮ
+	bool ThreatSolver::attack(int depth)
+	{
+		if (++nodes > maxNodes)
+		{
+			aborted = true;
+			return false;
+		}
+		Ply &ply = plies[depth];
+		emptiesOf(attacker, 4, ply.moves, 1);
+		if (!ply.moves.empty())
+		{
+			cache[hash] = ply.moves[0];
+			return true;
+		}
+		unordered_map<uint64_t, int32_t>::const_iterator it = cache.find(hash);
+		if (it != cache.end())
+			return it->second >= 0;
+
+		// Էг㣺϶²סһֻȥ£Ҷµֱв
+		emptiesOf(defender, 4, ply.forced, 2);
+		if (ply.forced.size() >= 2)
+			return false;
+		if (depth >= maxDepth)
+		{
+			depthCuts++;
+			return false;
+		}
+
+		emptiesOf(attacker, 3, ply.moves, (size_t)-1);
+		if (useThrees)
+		{
+			threeMoves(attacker, ply.aux);
+			for (size_t i = 0; i < ply.aux.size(); i++)
+			{
+				if (find(ply.moves.begin(), ply.moves.end(), ply.aux[i]) == ply.moves.end())
+					ply.moves.push_back(ply.aux[i]);
+			}
+		}
+		if (!ply.forced.empty())
+		{
+			int32_t only = ply.forced[0];
+			bool threat = find(ply.moves.begin(), ply.moves.end(), only) != ply.moves.end();
+			ply.moves.assign(threat ? 1 : 0, only);
+		}
+
+		// ĳǰ棨˫ֱӻʤ
+		ply.ordered.clear();
+		for (size_t i = 0; i < ply.moves.size(); i++)
+			ply.ordered.push_back(make_pair(fourCount(ply.moves[i], attacker), ply.moves[i]));
+		stable_sort(ply.ordered.begin(), ply.ordered.end(), [](const pair<int, int32_t> &a, const pair<int, int32_t> &b)
+		{
+			return a.first > b.first;
+		});
+
+		const uint64_t cutsBefore = depthCuts;
+		for (size_t i = 0; i < ply.ordered.size(); i++)
+		{
+			int32_t m = ply.ordered[i].second;
+			play(m, attacker);
+			bool win = defend(depth, m);
+			unplay();
+			if (aborted)
+				return false;
+			if (win)
+			{
+				cache[hash] = m;
+				return true;
+			}
+		}
+		// ȽضϵĽ۲ɿ
+		if (depthCuts == cutsBefore)
+			cache[hash] = -1;
+		return false;
+	}
+
+	//ط壨ڵ㣩ӦŶɹ
+	bool ThreatSolver::defend(int depth, int32_t move)
+	{
+		vector<int32_t> &blocks = plies[depth].aux;
+		emptiesOf(defender, 4, blocks, 1);
+		if (!blocks.empty())
+			return false;
+		replies(move, blocks);
+		for (size_t i = 0; i < blocks.size(); i++)
+		{
+			play(blocks[i], defender);
+			bool win = attack(depth + 1);
+			unplay();
+			if (!win)
+				return false;
+		}
+		return true;
+	}
+}
+
+bool SolveThreatSpace(const char *ChessBoard, int BoardSize, char attacker, const ChessThreatLimits &limits,
+                      ChessThreatResult &result)
+{
+	const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	result = ChessThreatResult();
+	ThreatSolver s;
+	s.table = GetChessLineTable(BoardSize);
+	if (s.table == nullptr || !InitLineCounters(&s.lines, BoardSize))
+		return false;
+	const int cells = BoardSize * BoardSize * BoardSize;
+	s.keys = GetChessZobristKeys(BoardSize);
+	s.board.assign(ChessBoard, ChessBoard + cells);
+	s.stamp.assign(cells, 0);
+	s.tally.assign(cells, 0);
+	s.attacker = attacker == '2' ? 1 : 0;
+	s.defender = s.attacker ^ 1;
+	s.maxNodes = limits.maxNodes > 0 ? limits.maxNodes : 1;
+	s.maxDepth = max(1, limits.maxDepth);
+	s.useThrees = limits.useThrees;
+
+	for (int c = 0; c < cells; c++)
+	{
+		if (ChessBoard[c] == 0)
+			continue;
+		int plane = ChessBoard[c] == '2' ? 1 : 0;
+		LineCountersPlace(s.lines, c, plane);
+		s.hash ^= s.keys[(size_t)c * 2 + plane];
+	}
+	for (int32_t line = 0; line < s.table->lineCount; line++)
+	{
+		for (int p = 0; p < 2; p++)
+		{
+			int k = s.lines.counts[(size_t)line * 2 + p];
+			if (k >= 2 && k <= 4 && s.lines.counts[(size_t)line * 2 + (p ^ 1)] == 0)
+				s.live[p][k].push_back(line);
+		}
+	}
+
+	s.plies.resize((size_t)s.maxDepth + 1);
+	bool win = s.attack(0);
+	result.nodes = min(s.nodes, s.maxNodes);
+	if (win)
+	{
+		result.status = ChessThreatStatus::Win;
+		// ػеıʤŷطĵһӦطųһ
+		vector<int32_t> replies;
+		for (int step = 0; step <= s.maxDepth; step++)
+		{
+			unordered_map<uint64_t, int32_t>::const_iterator it = s.cache.find(s.hash);
+			if (it == s.cache.end() || it->second < 0)
+				break;
+			int32_t m = it->second;
+			result.sequence.push_back(m);
+			s.play(m, s.attacker);
+			if (LineCountersWinDirection(s.lines, m, s.attacker) >= 0)
+				break;
+			s.replies(m, replies);
+			if (replies.empty())
+				break;
+			result.sequence.push_back(replies[0]);
+			s.play(replies[0], s.defender);
+		}
+		int first = result.sequence[0];
+		result.move[0] = first % BoardSize + 1;
+		result.move[1] = first / BoardSize % BoardSize + 1;
+		result.move[2] = first / (BoardSize * BoardSize) + 1;
+	}
+	else
+	{
+		result.status = s.aborted ? ChessThreatStatus::Unknown : ChessThreatStatus::NoWin;
+	}
+	result.elapsedUs = (uint64_t)chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+	FreeLineCounters(&s.lines);
+	return true;
+}
@@ -0,0 +1,71 @@
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "../include/chess-zobrist.h"
+using namespace std;
+
+
+//splitmix64ֱƵֻ(BoardSize, cell, plane)й
+static uint64_t SplitMix64(uint64_t x)
+{
+	x += 0x9E3779B97F4A7C15ull;
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+	return x ^ (x >> 31);
+}
+
+const uint64_t *GetChessZobristKeys(int BoardSize)
+{
+	if (BoardSize < 1)
+		return nullptr;
+	static mutex keysMutex;
+	static map<int, unique_ptr<vector<uint64_t>>> keySets;
+	lock_guard<mutex> lk(keysMutex);
+	unique_ptr<vector<uint64_t>> &slot = keySets[BoardSize];
+	if (!slot)
+	{
+		size_t n = (size_t)BoardSize * BoardSize * BoardSize * 2;
+		slot.reset(new vector<uint64_t>(n));
+		const uint64_t seed = (0xC3C3C3C3ull << 32) | (uint32_t)BoardSize;
+		for (size_t i = 0; i < n; i++)
+			(*slot)[i] = SplitMix64(SplitMix64(seed) ^ i);
+	}
+	return slot->data();
+}
+
+uint64_t ChessZobristHash(const char *ChessBoard, int BoardSize)
+{
+	const uint64_t *keys = GetChessZobristKeys(BoardSize);
+	const int cells = BoardSize * BoardSize * BoardSize;
+	uint64_t h = 0;
+	for (int c = 0; c < cells; c++)
+	{
+		if (ChessBoard[c] != 0)
+			h ^= keys[(size_t)c * 2 + (ChessBoard[c] == '2' ? 1 : 0)];
+	}
+	return h;
+}
+
+uint64_t ChessZobristHashBitBoard(const ChessBitBoard &board)
+{
+	const int BoardSize = board.boardSize;
+	const uint64_t *keys = GetChessZobristKeys(BoardSize);
+	uint64_t h = 0;
+	int c = 0;
+	for (int z = 1; z <= BoardSize; z++)
+	{
+		for (int y = 1; y <= BoardSize; y++)
+		{
+			int64_t index = BitBoardIndex(board, 1, y, z);
+			for (int x = 1; x <= BoardSize; x++, c++, index++)
+			{
+				if (BitBoardTest(board.planes[0].data(), index))
+					h ^= keys[(size_t)c * 2];
+				else if (BitBoardTest(board.planes[1].data(), index))
+					h ^= keys[(size_t)c * 2 + 1];
+			}
+		}
+	}
+	return h;
+}
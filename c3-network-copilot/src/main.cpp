@@ -1,6 +1,8 @@
 #include "../include/LanP2PNode.h"
 #include "../include/GameClient.h"
+#include "../include/chess-log.h"
 #include <iostream>
+#include <memory>
 #include <string>
 
 #define WIN32_LEAN_AND_MEAN
@@ -24,6 +26,7 @@ static BOOL WINAPI ConsoleCtrlHandler(DWORD ctrlType)
 		{
 			g_node->stop();
 		}
+		ChessLogFlush();
 		return TRUE;
 	}
 	return FALSE;
@@ -32,6 +35,7 @@ static BOOL WINAPI ConsoleCtrlHandler(DWORD ctrlType)
 // ׿̨˵
 static void printMenu()
 {
+	ChessLogFlush();
 	std::cout << "\n===== 3D  =====\n";
 	std::cout << "1. ʼ֣10룩\n";
 	std::cout << "2. гöԶ\n";
@@ -40,6 +44,10 @@ static void printMenu()
 	std::cout << "5. 鿴ǰԾϢ\n";
 	std::cout << "6. ǰԾ\n";
 	std::cout << "7. ˳\n";
+	std::cout << "8. /رAIй\n";
+	std::cout << "9. лAI㷨alpha-beta / MCTS\n";
+	std::cout << "10. /رAĮ˼Էغʱ\n";
+	std::cout << "11. ѡԴ/AIй/űļ/Զ̿ƣ\n";
 	std::cout << "ѡ: ";
 }
 
@@ -168,6 +176,70 @@ int main()
 			case 7:
 				running = false;
 				break;
+			case 8:
+				client.setEngineEnabled(!client.isEngineEnabled());
+				break;
+			case 9:
+				client.setEngineUseMcts(!client.isEngineUsingMcts());
+				break;
+			case 10:
+				client.setEnginePonder(!client.isEnginePondering());
+				break;
+			case 11:
+			{
+				std::cout << "1.   2. AIй  3. űļ  4. Զ̿ƣhost:port\nѡ: ";
+				std::string sel;
+				std::getline(std::cin, sel);
+				if (sel == "1" || sel == "2")
+				{
+					client.setEngineEnabled(sel == "2");
+					client.setMoveProvider(nullptr);
+				}
+				else if (sel == "3")
+				{
+					std::cout << "űļ·ÿ x y z: ";
+					std::string path;
+					std::getline(std::cin, path);
+					auto script = std::make_shared<ScriptedMoveProvider>(path);
+					if (!script->isLoaded())
+					{
+						std::cout << "űûпõӡ" << std::endl;
+						break;
+					}
+					std::cout << "Ѷȡ" << script->moveCount() << "" << std::endl;
+					client.setMoveProvider(script);
+				}
+				else if (sel == "4")
+				{
+					std::cout << "ƶ˵ַhost:port: ";
+					std::string addr;
+					std::getline(std::cin, addr);
+					size_t colon = addr.rfind(':');
+					int port = 0;
+					try
+					{
+						port = (colon == std::string::npos) ? 0 : std::stoi(addr.substr(colon + 1));
+					}
+					catch (...)
+					{
+						port = 0;
+					}
+					if (port <= 0 || port > 65535)
+					{
+						std::cout << "ַϷ" << std::endl;
+						break;
+					}
+					auto remote = std::make_shared<RemoteMoveProvider>(addr.substr(0, colon), (uint16_t)port);
+					if (!remote->connect())
+						break;
+					client.setMoveProvider(remote);
+				}
+				else
+				{
+					std::cout << "벻Ϸ" << std::endl;
+				}
+				break;
+			}
 			default:
 				std::cout << "벻Ϸ" << std::endl;
 		}
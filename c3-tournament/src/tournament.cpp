@@ -0,0 +1,433 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../../c3-network-copilot/include/chess-bitboard.h"
+#include "../../c3-network-copilot/include/chess-engine.h"
+#include "../../c3-network-copilot/include/chess-mcts.h"
+#include "../../c3-network-copilot/include/chess-symmetry.h"
+#include "../../c3-network-copilot/include/chess-zobrist.h"
+using namespace std;
+
+//ԶĽ̲߳壬ͳÿʤʼ䡢ÿʱλ
+//ȫڽУҪLanP2PNode
+//÷c3-tournament [--games 1000] [--threads 0] [--size 10] [--opening 2] [--max-moves 0] [--seed 1]
+//                    [--tt-mb 16] [--a ab:nodes=20000] [--b mcts:playouts=2000] [--json ·] [--book ·]
+//--bookalpha-betaֻѯÿֿ⣨½дԾֽ˳޹أÿǰbookPliesľʤͳ
+//abmctsðźɴŷָĲ depth= nodes= time= cand= vcf= patterns= playouts=
+//patterns=1alpha-betaҶμ --a ab:nodes=20000,patterns=1 --b ab:nodes=20000 Ƚ
+
+//ӵĸOpeningSpan^3壨̣
+static const int OpeningSpan = 3;
+
+struct EngineSpec
+{
+	string text;
+	bool mcts{ false };
+	ChessEngineLimits ab;
+	ChessMctsLimits mc;
+};
+
+struct TournamentConfig
+{
+	int games{ 1000 };
+	int threads{ 0 };            //<=0ʾʹȫ
+	int boardSize{ 10 };
+	int openingMoves{ 2 };       //ÿֿͷĸʹԾֻͬĸ
+	int maxMoves{ 0 };           //ƣ0ʾ
+	uint64_t seed{ 1 };
+	size_t ttMegabytes{ 16 };
+	EngineSpec engines[2];
+	string jsonPath;
+	string bookPath;
+	int bookPlies{ 16 };
+	uint64_t bookSlots{ 1 << 20 };
+};
+
+//ÿ̵߳ͳƣ
+struct WorkerStats
+{
+	uint64_t wins[2] {};         //A/Bʤ
+	uint64_t draws{ 0 };
+	uint64_t firstPlayerWins{ 0 };
+	uint64_t moves{ 0 };
+	uint64_t failures{ 0 };      //޷ϷӣΪԷʤ
+	uint64_t openingDecided{ 0 }; //ѷֳʤȷ
+	vector<uint32_t> latencyUs[2];
+};
+
+static bool ParseEngineSpec(const char *text, EngineSpec &spec)
+{
+	spec = EngineSpec();
+	spec.text = text;
+	string s(text);
+	size_t colon = s.find(':');
+	string kind = s.substr(0, colon);
+	if (kind == "mcts")
+		spec.mcts = true;
+	else if (kind != "ab")
+		return false;
+	// Ĭϣ̶ڵ/ģʱɸҲܻӰ
+	spec.ab.timeMs = 0;
+	spec.ab.maxNodes = 20000;
+	spec.ab.threads = 1;
+	spec.mc.timeMs = 0;
+	spec.mc.maxPlayouts = 2000;
+	spec.mc.threads = 1;
+	while (colon != string::npos)
+	{
+		size_t next = s.find(',', colon + 1);
+		string item = s.substr(colon + 1, next == string::npos ? string::npos : next - colon - 1);
+		size_t eq = item.find('=');
+		if (eq == string::npos)
+			return false;
+		string key = item.substr(0, eq);
+		long long v = atoll(item.c_str() + eq + 1);
+		if (key == "depth")
+			spec.ab.maxDepth = (int)v;
+		else if (key == "nodes")
+			spec.ab.maxNodes = (uint64_t)v;
+		else if (key == "time")
+			spec.ab.timeMs = spec.mc.timeMs = (int)v;
+		else if (key == "cand")
+			spec.ab.maxCandidates = (int)v;
+		else if (key == "vcf")
+			spec.ab.vcfNodes = (uint64_t)v;
+		else if (key == "patterns")
+			spec.ab.patternEval = v != 0;
+		else if (key == "playouts")
+			spec.mc.maxPlayouts = (uint64_t)v;
+		else
+			return false;
+		colon = next;
+	}
+	if (spec.mcts && spec.mc.timeMs <= 0 && spec.mc.maxPlayouts == 0)
+		return false;
+	return true;
+}
+
+//һ̣߳ͬһ̨棬ȡԾֱ
+static void WorkerLoop(const TournamentConfig &cfg, ChessBook *book, ChessBook *bookStats, atomic<int> &nextGame,
+                       atomic<int> &finished, WorkerStats &stats)
+{
+	const int N = cfg.boardSize;
+	ChessBitBoard board;
+	if (!OnlineInitBitBoard(&board, N))
+		return;
+	vector<char> chars((size_t)N * N * N);
+	unique_ptr<ChessEngine> ab[2];
+	unique_ptr<ChessMcts> mcts[2];
+	for (int e = 0; e < 2; e++)
+	{
+		if (cfg.engines[e].mcts)
+			mcts[e].reset(new ChessMcts());
+		else
+		{
+			ab[e].reset(new ChessEngine(cfg.ttMegabytes));
+			ab[e]->setBook(book);
+		}
+	}
+	// ֿͳƣÿ֮ǰĹ淶ϣ
+	const int32_t *symmetry = GetChessSymmetryTable(N);
+	const uint64_t *keys = GetChessZobristKeys(N);
+	ChessSymmetricHash hash;
+	vector<uint64_t> plyKeys;
+	const int maxMoves = cfg.maxMoves > 0 ? min(cfg.maxMoves, N * N * N) : N * N * N;
+
+	for (int game = nextGame++; game < cfg.games; game = nextGame++)
+	{
+		ClearBitBoard(board);
+		hash = ChessSymmetricHash();
+		plyKeys.clear();
+		for (int e = 0; e < 2; e++)
+		{
+			if (ab[e])
+				ab[e]->clear();
+		}
+		// żA֣B֣ͬһʹͬĿ
+		const int firstEngine = game % 2;
+		mt19937_64 rng(cfg.seed * 0x9E3779B97F4A7C15ull + (uint64_t)(game / 2));
+		char player = '1';
+		int moveCount = 0, winnerEngine = -1;
+		bool openingWon = false;
+		const int lo = max(1, N / 2 - 1), span = min(N, OpeningSpan);
+		for (int i = 0; i < cfg.openingMoves && moveCount < maxMoves; i++)
+		{
+			int in[3];
+			do
+			{
+				for (int k = 0; k < 3; k++)
+					in[k] = lo + (int)(rng() % span);
+			}
+			while (!BitBoardPlace(board, in, player));
+			const int cell = place(in[0], in[1], in[2], N);
+			SymmetricHashToggle(hash, symmetry, N * N * N, keys, cell, BitBoardPlane(player));
+			moveCount++;
+			if (LineCountersWinDirection(board.lines, cell, BitBoardPlane(player)) >= 0)
+			{
+				openingWon = true;
+				break;
+			}
+			player = player == '1' ? '2' : '1';
+		}
+		if (openingWon)
+		{
+			// 滹û߾ѷֳʤֲӳǿ
+			stats.openingDecided++;
+			stats.moves += moveCount;
+			int done = ++finished;
+			if (done % 50 == 0 || done == cfg.games)
+				fprintf(stderr, "\r%d/%d games", done, cfg.games);
+			continue;
+		}
+		while (moveCount < maxMoves)
+		{
+			const int e = (player == '1') ? firstEngine : firstEngine ^ 1;
+			if (book && moveCount < cfg.bookPlies)
+				plyKeys.push_back(SymmetricHashCanonical(hash));
+			int move[3] = { 0, 0, 0 };
+			bool ok;
+			chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+			if (mcts[e])
+			{
+				BitBoardToChars(board, chars.data());
+				ChessMctsResult r;
+				ok = mcts[e]->chooseMove(chars.data(), N, player, cfg.engines[e].mc, r);
+				memcpy(move, r.move, sizeof(move));
+			}
+			else
+			{
+				ChessEngineResult r;
+				ok = ab[e]->chooseMove(board, player, cfg.engines[e].ab, r);
+				memcpy(move, r.move, sizeof(move));
+			}
+			stats.latencyUs[e].push_back((uint32_t)chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - t0).count());
+			if (!ok || !BitBoardPlace(board, move, player))
+			{
+				stats.failures++;
+				winnerEngine = e ^ 1;
+				break;
+			}
+			SymmetricHashToggle(hash, symmetry, N * N * N, keys, place(move[0], move[1], move[2], N), BitBoardPlane(player));
+			moveCount++;
+			if (LineCountersWinDirection(board.lines, place(move[0], move[1], move[2], N), BitBoardPlane(player)) >= 0)
+			{
+				winnerEngine = e;
+				if (player == '1')
+					stats.firstPlayerWins++;
+				break;
+			}
+			player = player == '1' ? '2' : '1';
+		}
+		// plyKeys[i]֮ǰcfg.openingMoves+iֵһɲż
+		for (size_t i = 0; i < plyKeys.size(); i++)
+		{
+			const int mover = ((cfg.openingMoves + (int)i) % 2 == 0) ? firstEngine : firstEngine ^ 1;
+			bookStats->addResult(plyKeys[i], winnerEngine < 0 ? 1 : (winnerEngine == mover ? 2 : 0));
+		}
+		if (winnerEngine < 0)
+			stats.draws++;
+		else
+			stats.wins[winnerEngine]++;
+		stats.moves += moveCount;
+		int done = ++finished;
+		if (done % 50 == 0 || done == cfg.games)
+			fprintf(stderr, "\r%d/%d games", done, cfg.games);
+	}
+	FreeBitBoard(&board);
+}
+
+static double Percentile(const vector<uint32_t> &sorted, double q)
+{
+	if (sorted.empty())
+		return 0.0;
+	size_t i = (size_t)min((double)sorted.size() - 1, floor(q * (double)(sorted.size() - 1) + 0.5));
+	return sorted[i] / 1000.0;
+}
+
+//ʤʣư֣ΪElo
+static double EloFromScore(double score)
+{
+	score = min(max(score, 1e-4), 1.0 - 1e-4);
+	return -400.0 * log10(1.0 / score - 1.0);
+}
+
+static bool ParseArgs(int argc, char **argv, TournamentConfig &cfg)
+{
+	if (!ParseEngineSpec("ab", cfg.engines[0]) || !ParseEngineSpec("mcts", cfg.engines[1]))
+		return false;
+	for (int i = 1; i < argc; i++)
+	{
+		const char *key = argv[i];
+		if (i + 1 >= argc)
+			return false;
+		const char *value = argv[++i];
+		if (strcmp(key, "--games") == 0)
+			cfg.games = atoi(value);
+		else if (strcmp(key, "--threads") == 0)
+			cfg.threads = atoi(value);
+		else if (strcmp(key, "--size") == 0)
+			cfg.boardSize = atoi(value);
+		else if (strcmp(key, "--opening") == 0)
+			cfg.openingMoves = atoi(value);
+		else if (strcmp(key, "--max-moves") == 0)
+			cfg.maxMoves = atoi(value);
+		else if (strcmp(key, "--seed") == 0)
+			cfg.seed = strtoull(value, nullptr, 10);
+		else if (strcmp(key, "--tt-mb") == 0)
+			cfg.ttMegabytes = (size_t)max(1, atoi(value));
+		else if (strcmp(key, "--a") == 0 || strcmp(key, "--b") == 0)
+		{
+			if (!ParseEngineSpec(value, cfg.engines[key[2] == 'a' ? 0 : 1]))
+				return false;
+		}
+		else if (strcmp(key, "--json") == 0)
+			cfg.jsonPath = value;
+		else if (strcmp(key, "--book") == 0)
+			cfg.bookPath = value;
+		else
+			return false;
+	}
+	if (cfg.games <= 0 || cfg.boardSize < 5 || cfg.boardSize > ChessLineTableMaxSize)
+		return false;
+	// ֻӣһֱҲλ
+	const int span = min(cfg.boardSize, OpeningSpan);
+	cfg.openingMoves = min(max(cfg.openingMoves, 0), span * span * span);
+	if (cfg.maxMoves > 0)
+		cfg.openingMoves = min(cfg.openingMoves, cfg.maxMoves);
+	return true;
+}
+
+//÷ʵWilson䣨z=1.96ʤ10.50nֵıȫʤȫʱԸȵĽ
+static void WilsonInterval(double score, double n, double &low, double &high)
+{
+	const double z = 1.96, z2 = z * z;
+	const double center = (score + z2 / (2.0 * n)) / (1.0 + z2 / n);
+	const double half = z / (1.0 + z2 / n) * sqrt(score * (1.0 - score) / n + z2 / (4.0 * n * n));
+	low = max(0.0, center - half);
+	high = min(1.0, center + half);
+}
+
+int main(int argc, char **argv)
+{
+	TournamentConfig cfg;
+	if (!ParseArgs(argc, argv, cfg))
+	{
+		fprintf(stderr, "usage: c3-tournament [--games N] [--threads T] [--size 5..%d] [--opening K] [--max-moves M]\n"
+		        "                     [--seed S] [--tt-mb MB] [--a SPEC] [--b SPEC] [--json PATH] [--book PATH]\n"
+		        "SPEC: ab|mcts[:depth=D,nodes=N,time=MS,cand=C,vcf=N,playouts=P]\n", ChessLineTableMaxSize);
+		return 1;
+	}
+	int threadCount = cfg.threads > 0 ? cfg.threads : max(1, (int)thread::hardware_concurrency());
+	threadCount = min(threadCount, cfg.games);
+	fprintf(stderr, "A=%s  B=%s  size=%d games=%d threads=%d\n", cfg.engines[0].text.c_str(), cfg.engines[1].text.c_str(),
+	        cfg.boardSize, cfg.games, threadCount);
+
+	// ͬһļӳΣֻһݣstoreBook˲дͳÿдһ
+	ChessBook book, bookStats;
+	if (!cfg.bookPath.empty())
+	{
+		FILE *existing = fopen(cfg.bookPath.c_str(), "rb");
+		if (existing)
+			fclose(existing);
+		else if (!CreateChessBook(cfg.bookPath.c_str(), cfg.boardSize, cfg.bookSlots))
+			return 1;
+		if (!bookStats.open(cfg.bookPath.c_str(), true) || !book.open(cfg.bookPath.c_str()))
+			return 1;
+		if (book.boardSize() != cfg.boardSize)
+		{
+			fprintf(stderr, "book %s is for board size %d\n", cfg.bookPath.c_str(), book.boardSize());
+			return 1;
+		}
+	}
+
+	atomic<int> nextGame{ 0 }, finished{ 0 };
+	vector<WorkerStats> stats(threadCount);
+	vector<thread> workers;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for (int i = 0; i < threadCount; i++)
+		workers.push_back(thread(WorkerLoop, cref(cfg), book.isOpen() ? &book : (ChessBook *)nullptr, &bookStats, ref(nextGame),
+		                         ref(finished), ref(stats[i])));
+	for (size_t i = 0; i < workers.size(); i++)
+		workers[i].join();
+	const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	fprintf(stderr, "\n");
+
+	WorkerStats total;
+	for (const WorkerStats &w : stats)
+	{
+		for (int e = 0; e < 2; e++)
+		{
+			total.wins[e] += w.wins[e];
+			total.latencyUs[e].insert(total.latencyUs[e].end(), w.latencyUs[e].begin(), w.latencyUs[e].end());
+		}
+		total.draws += w.draws;
+		total.firstPlayerWins += w.firstPlayerWins;
+		total.moves += w.moves;
+		total.failures += w.failures;
+		total.openingDecided += w.openingDecided;
+	}
+	const double games = (double)(total.wins[0] + total.wins[1] + total.draws);
+	if (games == 0)
+		return 1;
+
+	// Aĵ÷֣ʤ10.5095%Wilson䣨̬0%/100%ʱΪ0
+	const double score = ((double)total.wins[0] + 0.5 * (double)total.draws) / games;
+	double scoreLow, scoreHigh;
+	WilsonInterval(score, games, scoreLow, scoreHigh);
+
+	printf("games            %.0f in %.2fs, %.2f games/s, %.1f moves/game\n", games, seconds, games / seconds,
+	       (double)total.moves / games);
+	printf("A %-14s wins %llu (%.1f%%)\n", cfg.engines[0].text.c_str(), (unsigned long long)total.wins[0],
+	       100.0 * (double)total.wins[0] / games);
+	printf("B %-14s wins %llu (%.1f%%)\n", cfg.engines[1].text.c_str(), (unsigned long long)total.wins[1],
+	       100.0 * (double)total.wins[1] / games);
+	printf("draws            %llu, first player won %.1f%%, engine failures %llu\n", (unsigned long long)total.draws,
+	       100.0 * (double)total.firstPlayerWins / games, (unsigned long long)total.failures);
+	if (total.openingDecided > 0)
+		printf("opening decided  %llu (not scored)\n", (unsigned long long)total.openingDecided);
+	printf("A score          %.3f [%.3f, %.3f] (95%%), Elo %+.0f [%+.0f, %+.0f]\n", score, scoreLow, scoreHigh, EloFromScore(score),
+	       EloFromScore(scoreLow), EloFromScore(scoreHigh));
+	double pct[2][4];
+	for (int e = 0; e < 2; e++)
+	{
+		vector<uint32_t> &lat = total.latencyUs[e];
+		sort(lat.begin(), lat.end());
+		pct[e][0] = Percentile(lat, 0.50);
+		pct[e][1] = Percentile(lat, 0.90);
+		pct[e][2] = Percentile(lat, 0.99);
+		pct[e][3] = lat.empty() ? 0.0 : lat.back() / 1000.0;
+		printf("%c move latency   p50 %.2fms  p90 %.2fms  p99 %.2fms  max %.2fms  (%zu moves)\n", 'A' + e, pct[e][0], pct[e][1],
+		       pct[e][2], pct[e][3], lat.size());
+	}
+
+	if (!cfg.jsonPath.empty())
+	{
+		FILE *f = fopen(cfg.jsonPath.c_str(), "w");
+		if (!f)
+		{
+			fprintf(stderr, "cannot write %s\n", cfg.jsonPath.c_str());
+			return 1;
+		}
+		fprintf(f, "{\n  \"schema\": 1,\n  \"boardSize\": %d,\n  \"games\": %.0f,\n  \"seconds\": %.3f,\n  \"gamesPerSec\": %.3f,\n",
+		        cfg.boardSize, games, seconds, games / seconds);
+		fprintf(f, "  \"draws\": %llu,\n  \"scoreA\": %.4f,\n  \"scoreA95Low\": %.4f,\n  \"scoreA95High\": %.4f,\n  \"eloA\": %.1f,\n  \"engines\": [\n",
+		        (unsigned long long)total.draws, score, scoreLow, scoreHigh, EloFromScore(score));
+		for (int e = 0; e < 2; e++)
+			fprintf(f, "    {\"spec\": \"%s\", \"wins\": %llu, \"p50Ms\": %.3f, \"p90Ms\": %.3f, \"p99Ms\": %.3f, \"maxMs\": %.3f}%s\n",
+			        cfg.engines[e].text.c_str(), (unsigned long long)total.wins[e], pct[e][0], pct[e][1], pct[e][2], pct[e][3],
+			        e == 0 ? "," : "");
+		fprintf(f, "  ]\n}\n");
+		fclose(f);
+	}
+	return 0;
+}